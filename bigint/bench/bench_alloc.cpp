@@ -0,0 +1,97 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+volatile bool sink;
+size_t allocations = 0;
+
+// heap allocations per call of f
+double mallocs_per_op(const std::function<void()>& f) {
+  constexpr size_t ITERATIONS = 1000;
+  size_t before = allocations;
+  for (size_t i = 0; i < ITERATIONS; ++i) {
+    f();
+  }
+  return static_cast<double>(allocations - before) / ITERATIONS;
+}
+} // namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+// Prints the number of heap allocations per operator for operands of 1 to 8 limbs
+int main() {
+  const size_t sizes[] = {1, 2, 4, 8};
+
+  std::printf("%-12s", "op");
+  for (size_t limbs : sizes) {
+    std::printf(" %8zu limbs", limbs);
+  }
+  std::printf("\n");
+
+  std::vector<std::pair<std::string, std::vector<double>>> rows;
+  for (size_t limbs : sizes) {
+    big_integer a = random_number(limbs * LIMB_BITS);
+    big_integer b = -random_number(limbs * LIMB_BITS);
+    big_integer half = random_number(limbs * LIMB_BITS / 2) + 1;
+    big_integer x = half;
+
+    std::vector<std::pair<std::string, std::function<void()>>> ops = {
+        {"copy", [&] { big_integer c = a; }},
+        {"a + b", [&] { big_integer c = a + b; }},
+        {"a - b", [&] { big_integer c = a - b; }},
+        {"a * b", [&] { big_integer c = a * b; }},
+        {"a / half", [&] { big_integer c = a / half; }},
+        {"a % half", [&] { big_integer c = a % half; }},
+        {"a & b", [&] { big_integer c = a & b; }},
+        {"a << 3", [&] { big_integer c = a << 3; }},
+        {"a >> 3", [&] { big_integer c = a >> 3; }},
+        {"-a", [&] { big_integer c = -a; }},
+        {"x = a; x = b", [&] {
+           x = a;
+           x = b;
+         }},
+        {"a*b + b*a", [&] { big_integer c = a * b + b * a; }},
+        {"(a+b)*a-b", [&] { big_integer c = (a + b) * a - b; }},
+        {"a*b << 3 | a", [&] { big_integer c = (a * b << 3) | a; }},
+        {"++a", [&] { ++a; }},
+        {"--a", [&] { --a; }},
+        {"a < 1", [&] { sink = a < 1; }},
+        {"a == b", [&] { sink = a == b; }},
+    };
+    for (size_t i = 0; i < ops.size(); ++i) {
+      if (rows.size() <= i) {
+        rows.emplace_back(ops[i].first, std::vector<double>());
+      }
+      rows[i].second.push_back(mallocs_per_op(ops[i].second));
+    }
+  }
+
+  for (const auto& [name, counts] : rows) {
+    std::printf("%-12s", name.c_str());
+    for (double count : counts) {
+      std::printf(" %14.2f", count);
+    }
+    std::printf("\n");
+  }
+}
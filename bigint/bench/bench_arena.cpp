@@ -0,0 +1,49 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+constexpr size_t BATCH = 10'000;
+
+// a batch of short-lived expressions whose results are kept until the whole batch is dropped
+template <typename Expression>
+void run_batch(const std::vector<big_integer>& a, const std::vector<big_integer>& b, Expression expression) {
+  std::vector<big_integer> results;
+  results.reserve(BATCH);
+  for (size_t i = 0; i < BATCH; ++i) {
+    results.push_back(expression(a[i % a.size()], b[i % b.size()]));
+  }
+}
+
+template <typename Expression>
+double measure_in_arena(const std::vector<big_integer>& a, const std::vector<big_integer>& b, Expression expression) {
+  return measure([&] {
+    big_integer_arena arena;
+    run_batch(a, b, expression);
+  });
+}
+} // namespace
+
+// Prints the time of a batch of expressions with limbs taken from the global heap and from an arena,
+// additions are dominated by allocations and products by the multiplication itself
+int main() {
+  auto sum = [](const big_integer& x, const big_integer& y) { return (x + y) - (y << 1); };
+  auto product = [](const big_integer& x, const big_integer& y) { return (x * y + x) * 3 - y; };
+
+  std::printf("%8s %14s %14s %14s %14s\n", "limbs", "add heap,us", "add arena,us", "mul heap,us", "mul arena,us");
+  for (size_t limbs : {8, 32, 128}) {
+    std::vector<big_integer> a, b;
+    for (size_t i = 0; i < 64; ++i) {
+      a.push_back(random_number(limbs * LIMB_BITS));
+      b.push_back(random_number(limbs * LIMB_BITS));
+    }
+
+    double sum_heap = measure([&] { run_batch(a, b, sum); });
+    double sum_arena = measure_in_arena(a, b, sum);
+    double product_heap = measure([&] { run_batch(a, b, product); });
+    double product_arena = measure_in_arena(a, b, product);
+
+    std::printf("%8zu %14.1f %14.1f %14.1f %14.1f\n", limbs, sum_heap, sum_arena, product_heap, product_arena);
+  }
+}
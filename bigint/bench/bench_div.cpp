@@ -0,0 +1,26 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <limits>
+
+// Prints the time of dividing a 2n-limb number by an n-limb one with Knuth's algorithm D and with
+// Barrett reduction by a Newton reciprocal, the crossover is the row where the faster column changes.
+int main() {
+  constexpr size_t NEVER = std::numeric_limits<size_t>::max();
+  const size_t newton = big_integer::newton_threshold;
+
+  std::printf("%8s %14s %14s\n", "limbs", "knuth,us", "newton,us");
+  for (size_t n = 16; n <= 32768; n += n / 4) {
+    big_integer a = random_number(2 * n * LIMB_BITS);
+    big_integer b = random_number(n * LIMB_BITS);
+
+    big_integer::newton_threshold = NEVER;
+    double knuth_time = n <= 8192 ? measure([&] { big_integer c = a / b; }) : 0;
+
+    big_integer::newton_threshold = n;
+    double newton_time = measure([&] { big_integer c = a / b; });
+
+    std::printf("%8zu %14.2f %14.2f\n", n, knuth_time, newton_time);
+  }
+  big_integer::newton_threshold = newton;
+}
@@ -0,0 +1,74 @@
+#include "bench_utils.h"
+#include "fixed_big_integer.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t COUNT = 64;
+
+// time of one op(a[i], b[i]) in nanoseconds over COUNT operand pairs
+template <typename T, typename Op>
+double per_op(const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& out, Op op) {
+  return measure([&] {
+           for (size_t i = 0; i < COUNT; ++i) {
+             out[i] = op(a[i], b[i]);
+           }
+         }) *
+         1000 / COUNT;
+}
+
+template <size_t Bits>
+void run() {
+  using fixed = fixed_big_integer<Bits>;
+  std::vector<big_integer> a, b, out(COUNT);
+  std::vector<fixed> fa, fb, fout(COUNT);
+  for (size_t i = 0; i < COUNT; ++i) {
+    // operands of the full width with the top bit clear, divisors of half of it
+    a.push_back(random_number(Bits - 1));
+    b.push_back(random_number(i % 2 == 0 ? Bits - 1 : Bits / 2) + 1);
+    fa.emplace_back(a.back());
+    fb.emplace_back(b.back());
+  }
+
+  auto row = [&](const char* name, auto op) {
+    double big_time = per_op(a, b, out, op);
+    double fixed_time = per_op(fa, fb, fout, op);
+    std::printf("%6zu %-10s %12.1f %12.1f %8.1fx\n", Bits, name, big_time, fixed_time, big_time / fixed_time);
+  };
+  row("a + b", [](const auto& x, const auto& y) { return x + y; });
+  row("a - b", [](const auto& x, const auto& y) { return x - y; });
+  row("a * b", [](const auto& x, const auto& y) { return x * y; });
+  row("a / b", [](const auto& x, const auto& y) { return x / y; });
+  row("a % b", [](const auto& x, const auto& y) { return x % y; });
+  row("a ^ b", [](const auto& x, const auto& y) { return x ^ y; });
+  row("a << 67", [](const auto& x, const auto&) { return x << 67; });
+  row("a >> 67", [](const auto& x, const auto&) { return x >> 67; });
+  row("a < b", [](const auto& x, const auto& y) { return x < y ? x : y; });
+
+  std::vector<std::string> strings(COUNT);
+  double big_time = measure([&] {
+                      for (size_t i = 0; i < COUNT; ++i) {
+                        strings[i] = to_string(a[i]);
+                      }
+                    }) *
+                    1000 / COUNT;
+  double fixed_time = measure([&] {
+                        for (size_t i = 0; i < COUNT; ++i) {
+                          strings[i] = to_string(fa[i]);
+                        }
+                      }) *
+                      1000 / COUNT;
+  std::printf("%6zu %-10s %12.1f %12.1f %8.1fx\n", Bits, "to_string", big_time, fixed_time, big_time / fixed_time);
+}
+} // namespace
+
+// Prints the time of the operators of big_integer and fixed_big_integer on the same values, in nanoseconds
+int main() {
+  std::printf("%6s %-10s %12s %12s %9s\n", "bits", "op", "big,ns", "fixed,ns", "speedup");
+  run<128>();
+  run<256>();
+  run<512>();
+  run<1024>();
+}
@@ -0,0 +1,37 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <vector>
+
+// Prints the time of a 16-term dot product accumulated with acc += a * b and with addmul,
+// and of a single a * b % m against mul_mod, for operands of the given number of limbs.
+int main() {
+  constexpr size_t TERMS = 16;
+
+  std::printf("%8s %14s %14s %14s %14s\n", "limbs", "+= a*b,us", "addmul,us", "a*b%m,us", "mul_mod,us");
+  for (size_t limbs : {2, 8, 32, 128, 1024}) {
+    std::vector<big_integer> a, b;
+    for (size_t i = 0; i < TERMS; ++i) {
+      a.push_back(random_number(limbs * LIMB_BITS));
+      b.push_back(i % 2 == 0 ? random_number(limbs * LIMB_BITS) : -random_number(limbs * LIMB_BITS));
+    }
+    big_integer m = random_number(limbs * LIMB_BITS);
+
+    double naive_time = measure([&] {
+      big_integer acc;
+      for (size_t i = 0; i < TERMS; ++i) {
+        acc += a[i] * b[i];
+      }
+    });
+    double fused_time = measure([&] {
+      big_integer acc;
+      for (size_t i = 0; i < TERMS; ++i) {
+        addmul(acc, a[i], b[i]);
+      }
+    });
+    double naive_mod_time = measure([&] { big_integer c = a[0] * a[1] % m; });
+    double mul_mod_time = measure([&] { big_integer c = mul_mod(a[0], a[1], m); });
+
+    std::printf("%8zu %14.3f %14.3f %14.3f %14.3f\n", limbs, naive_time, fused_time, naive_mod_time, mul_mod_time);
+  }
+}
@@ -0,0 +1,60 @@
+#include "bench_utils.h"
+
+#include <gmp.h>
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+namespace {
+void to_mpz(mpz_t out, const big_integer& value) {
+  mpz_set_str(out, to_string(value).c_str(), 10);
+}
+
+// Euclid by repeated %, what gcd replaces
+big_integer naive_gcd(big_integer a, big_integer b) {
+  while (b != 0) {
+    a %= b;
+    std::swap(a, b);
+  }
+  return a;
+}
+} // namespace
+
+// Prints the time of gcd and xgcd of two random numbers: repeated %, Lehmer's algorithm alone, gcd with the
+// half-GCD above hgcd_threshold and GMP's mpz_gcd, then xgcd and mpz_gcdext.
+// An optional argument overrides hgcd_threshold to tune it.
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    big_integer::hgcd_threshold = std::stoul(argv[1]);
+  }
+  size_t threshold = big_integer::hgcd_threshold;
+
+  std::printf("%8s %14s %14s %14s %14s %14s %14s\n", "bits", "naive,us", "lehmer,us", "gcd,us", "mpz_gcd,us",
+              "xgcd,us", "mpz_gcdext,us");
+  for (size_t bits = 256; bits <= (1 << 20); bits *= 4) {
+    big_integer a = random_number(bits);
+    big_integer b = random_number(bits);
+
+    double naive_time = bits <= 65536 ? measure([&] { big_integer g = naive_gcd(a, b); }) : 0;
+    big_integer::hgcd_threshold = static_cast<size_t>(-1) / LIMB_BITS;
+    double lehmer_time = bits <= 262144 ? measure([&] { big_integer g = gcd(a, b); }) : 0;
+    big_integer::hgcd_threshold = threshold;
+    double gcd_time = measure([&] { big_integer g = gcd(a, b); });
+    double xgcd_time = measure([&] {
+      big_integer x, y;
+      big_integer g = xgcd(a, b, x, y);
+    });
+
+    mpz_t ma, mb, g, x, y;
+    mpz_inits(ma, mb, g, x, y, nullptr);
+    to_mpz(ma, a);
+    to_mpz(mb, b);
+    double gmp_time = measure([&] { mpz_gcd(g, ma, mb); });
+    double gmp_ext_time = measure([&] { mpz_gcdext(g, x, y, ma, mb); });
+    mpz_clears(ma, mb, g, x, y, nullptr);
+
+    std::printf("%8zu %14.2f %14.2f %14.2f %14.2f %14.2f %14.2f\n", bits, naive_time, lehmer_time, gcd_time,
+                gmp_time, xgcd_time, gmp_ext_time);
+  }
+}
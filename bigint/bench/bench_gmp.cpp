@@ -0,0 +1,96 @@
+#include "bench_utils.h"
+
+#include <gmp.h>
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+struct result {
+  std::string op;
+  size_t limbs;
+  double ours;
+  double gmp;
+};
+
+struct operation {
+  const char* name;
+  std::function<void()> ours;
+  std::function<void()> gmp;
+};
+
+void to_mpz(mpz_t out, const big_integer& value) {
+  std::vector<unsigned char> bytes(export_words(value, 1));
+  export_bytes(value, bytes.data(), 1);
+  mpz_import(out, bytes.size(), -1, 1, 0, 0, bytes.data());
+}
+
+void print_csv(const std::vector<result>& results) {
+  std::printf("op,limbs,big_integer_us,gmp_us,ratio\n");
+  for (const result& r : results) {
+    std::printf("%s,%zu,%.3f,%.3f,%.2f\n", r.op.c_str(), r.limbs, r.ours, r.gmp, r.ours / r.gmp);
+  }
+}
+
+void print_json(const std::vector<result>& results) {
+  std::printf("[\n");
+  for (size_t i = 0; i < results.size(); ++i) {
+    const result& r = results[i];
+    std::printf("  {\"op\": \"%s\", \"limbs\": %zu, \"big_integer_us\": %.3f, \"gmp_us\": %.3f, \"ratio\": %.2f}%s\n",
+                r.op.c_str(), r.limbs, r.ours, r.gmp, r.ours / r.gmp, i + 1 == results.size() ? "" : ",");
+  }
+  std::printf("]\n");
+}
+} // namespace
+
+// Times every operator of big_integer and its GMP counterpart on random operands of 1, 4, 16, ... limbs up to
+// the second argument (2^20 by default), division takes a dividend twice as long as the divisor.
+// GMP writes into a reused mpz_t, while every big_integer result is a fresh object, as the operators return them.
+// Prints a CSV report, or a JSON one if the first argument is "json"; ratio is big_integer time over GMP time.
+int main(int argc, char** argv) {
+  bool json = argc > 1 && std::strcmp(argv[1], "json") == 0;
+  size_t max_limbs = argc > 2 ? std::stoul(argv[2]) : 1 << 20;
+
+  std::vector<result> results;
+  for (size_t limbs = 1; limbs <= max_limbs; limbs *= 4) {
+    big_integer a = random_number(limbs * LIMB_BITS);
+    big_integer b = random_number(limbs * LIMB_BITS);
+    big_integer wide = random_number(2 * limbs * LIMB_BITS);
+    std::string str = to_string(a);
+
+    mpz_t za, zb, zwide, zr;
+    mpz_inits(za, zb, zwide, zr, nullptr);
+    to_mpz(za, a);
+    to_mpz(zb, b);
+    to_mpz(zwide, wide);
+    std::vector<char> buf(str.size() + 2);
+
+    std::vector<operation> ops = {
+        {"a + b", [&] { big_integer c = a + b; }, [&] { mpz_add(zr, za, zb); }},
+        {"a - b", [&] { big_integer c = a - b; }, [&] { mpz_sub(zr, za, zb); }},
+        {"a * b", [&] { big_integer c = a * b; }, [&] { mpz_mul(zr, za, zb); }},
+        {"2n / n", [&] { big_integer c = wide / b; }, [&] { mpz_tdiv_q(zr, zwide, zb); }},
+        {"2n % n", [&] { big_integer c = wide % b; }, [&] { mpz_tdiv_r(zr, zwide, zb); }},
+        {"a << 67", [&] { big_integer c = a << 67; }, [&] { mpz_mul_2exp(zr, za, 67); }},
+        {"a >> 67", [&] { big_integer c = a >> 67; }, [&] { mpz_fdiv_q_2exp(zr, za, 67); }},
+        {"a & b", [&] { big_integer c = a & b; }, [&] { mpz_and(zr, za, zb); }},
+        {"a | b", [&] { big_integer c = a | b; }, [&] { mpz_ior(zr, za, zb); }},
+        {"a ^ b", [&] { big_integer c = a ^ b; }, [&] { mpz_xor(zr, za, zb); }},
+        {"to_string", [&] { std::string c = to_string(a); }, [&] { mpz_get_str(buf.data(), 10, za); }},
+        {"from string", [&] { big_integer c(str); }, [&] { mpz_set_str(zr, str.c_str(), 10); }},
+    };
+    for (const operation& op : ops) {
+      results.push_back({op.name, limbs, measure(op.ours), measure(op.gmp)});
+    }
+    mpz_clears(za, zb, zwide, zr, nullptr);
+  }
+
+  if (json) {
+    print_json(results);
+  } else {
+    print_csv(results);
+  }
+}
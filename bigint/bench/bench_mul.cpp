@@ -0,0 +1,48 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <limits>
+
+namespace {
+double measure_mul(const big_integer& a, const big_integer& b) {
+  return measure([&] { big_integer c = a * b; });
+}
+} // namespace
+
+// Prints the time of a single multiplication of two n-limb numbers for every algorithm used at the top level
+// of the recursion (lower levels use the default thresholds), the crossovers are the rows where the faster column changes.
+int main() {
+  constexpr size_t NEVER = std::numeric_limits<size_t>::max();
+  const size_t karatsuba = big_integer::karatsuba_threshold;
+  const size_t toom3 = big_integer::toom3_threshold;
+  const size_t ntt = big_integer::ntt_threshold;
+
+  std::printf("%8s %14s %14s %14s %14s %14s\n", "limbs", "schoolbook,us", "karatsuba,us", "toom3,us", "ntt,us",
+              "ntt square,us");
+  for (size_t n = 8; n <= 65536; n += n / 4) {
+    big_integer a = random_number(n * LIMB_BITS);
+    big_integer b = random_number(n * LIMB_BITS);
+
+    big_integer::karatsuba_threshold = NEVER;
+    big_integer::toom3_threshold = NEVER;
+    big_integer::ntt_threshold = NEVER;
+    double schoolbook_time = n <= 4096 ? measure_mul(a, b) : 0;
+
+    big_integer::karatsuba_threshold = karatsuba;
+    double karatsuba_time = n <= 16384 ? measure_mul(a, b) : 0;
+
+    big_integer::toom3_threshold = n;
+    double toom3_time = measure_mul(a, b);
+
+    big_integer::toom3_threshold = toom3;
+    big_integer::ntt_threshold = n;
+    double ntt_time = measure_mul(a, b);
+    double ntt_square_time = measure_mul(a, a);
+
+    std::printf("%8zu %14.2f %14.2f %14.2f %14.2f %14.2f\n", n, schoolbook_time, karatsuba_time, toom3_time, ntt_time,
+                ntt_square_time);
+  }
+  big_integer::karatsuba_threshold = karatsuba;
+  big_integer::toom3_threshold = toom3;
+  big_integer::ntt_threshold = ntt;
+}
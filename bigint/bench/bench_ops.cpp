@@ -0,0 +1,64 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+volatile bool sink;
+} // namespace
+
+// Prints the time of every operator for a few operand sizes, division takes a dividend twice as long as the divisor
+int main() {
+  const size_t sizes[] = {256, 4096, 65536};
+
+  std::printf("%-12s", "op");
+  for (size_t bits : sizes) {
+    std::printf(" %12zu bits,us", bits);
+  }
+  std::printf("\n");
+
+  std::vector<std::pair<std::string, std::vector<double>>> rows;
+  for (size_t bits : sizes) {
+    big_integer a = random_number(bits);
+    big_integer b = -random_number(bits);
+    big_integer wide = random_number(2 * bits);
+    std::string str = to_string(a);
+
+    std::vector<std::pair<std::string, std::function<void()>>> ops = {
+        {"a + b", [&] { big_integer c = a + b; }},
+        {"a - b", [&] { big_integer c = a - b; }},
+        {"a * b", [&] { big_integer c = a * b; }},
+        {"2n / n", [&] { big_integer c = wide / b; }},
+        {"2n % n", [&] { big_integer c = wide % b; }},
+        {"a & b", [&] { big_integer c = a & b; }},
+        {"a | b", [&] { big_integer c = a | b; }},
+        {"a ^ b", [&] { big_integer c = a ^ b; }},
+        {"~a", [&] { big_integer c = ~a; }},
+        {"a << 67", [&] { big_integer c = a << 67; }},
+        {"a >> 67", [&] { big_integer c = a >> 67; }},
+        {"++a", [&] { ++a; }},
+        {"--a", [&] { --a; }},
+        {"a < b", [&] { sink = a < b; }},
+        {"a == b", [&] { sink = a == b; }},
+        {"to_string", [&] { std::string c = to_string(a); }},
+        {"from string", [&] { big_integer c(str); }},
+    };
+    for (size_t i = 0; i < ops.size(); ++i) {
+      if (rows.size() <= i) {
+        rows.emplace_back(ops[i].first, std::vector<double>());
+      }
+      rows[i].second.push_back(measure(ops[i].second));
+    }
+  }
+
+  for (const auto& [name, times] : rows) {
+    std::printf("%-12s", name.c_str());
+    for (double time : times) {
+      std::printf(" %17.3f", time);
+    }
+    std::printf("\n");
+  }
+}
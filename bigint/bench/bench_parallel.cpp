@@ -0,0 +1,53 @@
+#include "bench_utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+// shifting in 32 bits at a time is quadratic, so large operands are parsed from random digits instead
+big_integer random_decimal(size_t digits) {
+  static std::mt19937 rng(7);
+  std::string str(digits, '0');
+  for (char& c : str) {
+    c = static_cast<char>('0' + rng() % 10);
+  }
+  str[0] = '1';
+  return big_integer(str);
+}
+} // namespace
+
+// Prints the time of a product, to_string and parsing for 1 to hardware_concurrency threads (or as many as given
+// in the first argument), each followed by the speedup over a single thread; the operands are well above
+// parallel_threshold
+int main(int argc, char** argv) {
+  size_t max_threads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+
+  for (size_t digits : {100'000, 300'000, 1'000'000}) {
+    big_integer a = random_decimal(digits);
+    big_integer b = random_decimal(digits);
+    std::string str = to_string(a);
+
+    std::printf("%zu digits\n%8s %18s %18s %18s\n", digits, "threads", "a * b,us", "to_string,us", "from string,us");
+    double base[3] = {};
+    for (size_t threads = 1; threads <= max_threads; ++threads) {
+      big_integer::thread_count = threads;
+      double times[3] = {
+          measure([&] { big_integer c = a * b; }),
+          measure([&] { std::string c = to_string(a); }),
+          measure([&] { big_integer c(str); }),
+      };
+      std::printf("%8zu", threads);
+      for (size_t i = 0; i < 3; ++i) {
+        if (threads == 1) {
+          base[i] = times[i];
+        }
+        std::printf(" %12.0f %4.2fx", times[i], base[i] / times[i]);
+      }
+      std::printf("\n");
+    }
+  }
+  big_integer::thread_count = 1;
+}
@@ -0,0 +1,52 @@
+#include "bench_utils.h"
+
+#include <gmp.h>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+void to_mpz(mpz_t out, const big_integer& value) {
+  mpz_set_str(out, to_string(value).c_str(), 10);
+}
+
+// modular exponentiation by repeated * and %, what pow_mod replaces
+big_integer naive_pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod) {
+  big_integer res = 1;
+  for (int i = static_cast<int>(to_string(exp).size() * 4); i >= 0; --i) {
+    res *= res;
+    res %= mod;
+    if (((exp >> i) & 1) != 0) {
+      res *= base;
+      res %= mod;
+    }
+  }
+  return res;
+}
+} // namespace
+
+// Prints the time of base^exp mod m for a random odd modulus and a full size exponent:
+// repeated * and %, pow_mod, a reused montgomery_context and GMP's mpz_powm.
+int main() {
+  std::printf("%8s %14s %14s %14s %14s\n", "bits", "naive,us", "pow_mod,us", "context,us", "mpz_powm,us");
+  for (size_t bits = 256; bits <= 8192; bits *= 2) {
+    big_integer mod = random_number(bits) | 1;
+    big_integer base = random_number(bits) % mod;
+    big_integer exp = random_number(bits);
+    montgomery_context context(mod);
+
+    double naive_time = bits <= 4096 ? measure([&] { big_integer r = naive_pow_mod(base, exp, mod); }) : 0;
+    double pow_mod_time = measure([&] { big_integer r = pow_mod(base, exp, mod); });
+    double context_time = measure([&] { big_integer r = context.pow(base, exp); });
+
+    mpz_t b, e, m, r;
+    mpz_inits(b, e, m, r, nullptr);
+    to_mpz(b, base);
+    to_mpz(e, exp);
+    to_mpz(m, mod);
+    double gmp_time = measure([&] { mpz_powm(r, b, e, m); });
+    mpz_clears(b, e, m, r, nullptr);
+
+    std::printf("%8zu %14.2f %14.2f %14.2f %14.2f\n", bits, naive_time, pow_mod_time, context_time, gmp_time);
+  }
+}
@@ -0,0 +1,41 @@
+#include "bench_utils.h"
+
+#include <gmp.h>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+void to_mpz(mpz_t out, const big_integer& value) {
+  mpz_set_str(out, to_string(value).c_str(), 10);
+}
+} // namespace
+
+// Prints the time of a square, isqrt and the cube root of a random number and of a 64-bit base raised
+// to the power that gives the same size, next to GMP's mpz_sqrt, mpz_root and mpz_pow_ui.
+int main() {
+  std::printf("%8s %12s %12s %12s %12s %12s %12s %12s\n", "bits", "a*a,us", "isqrt,us", "mpz_sqrt,us", "iroot3,us",
+              "mpz_root,us", "pow,us", "mpz_pow,us");
+  for (size_t bits = 256; bits <= (1 << 20); bits *= 4) {
+    big_integer a = random_number(bits);
+    big_integer base = random_number(LIMB_BITS);
+    uint64_t exp = bits / LIMB_BITS;
+
+    double square_time = measure([&] { big_integer r = a * a; });
+    double sqrt_time = measure([&] { big_integer r = isqrt(a); });
+    double root_time = measure([&] { big_integer r = iroot(a, 3); });
+    double pow_time = measure([&] { big_integer r = pow(base, exp); });
+
+    mpz_t ma, mb, r;
+    mpz_inits(ma, mb, r, nullptr);
+    to_mpz(ma, a);
+    to_mpz(mb, base);
+    double gmp_sqrt_time = measure([&] { mpz_sqrt(r, ma); });
+    double gmp_root_time = measure([&] { mpz_root(r, ma, 3); });
+    double gmp_pow_time = measure([&] { mpz_pow_ui(r, mb, exp); });
+    mpz_clears(ma, mb, r, nullptr);
+
+    std::printf("%8zu %12.2f %12.2f %12.2f %12.2f %12.2f %12.2f %12.2f\n", bits, square_time, sqrt_time,
+                gmp_sqrt_time, root_time, gmp_root_time, pow_time, gmp_pow_time);
+  }
+}
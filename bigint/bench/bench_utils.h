@@ -0,0 +1,38 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+inline constexpr size_t LIMB_BITS = std::numeric_limits<big_integer::data_type>::digits;
+
+// (bits + 31) / 32 random 32-bit words, the most significant one is drawn first
+inline big_integer random_number(size_t bits) {
+  static std::mt19937 rng(42);
+  std::vector<uint32_t> words((bits + 31) / 32);
+  for (uint32_t& word : words) {
+    word = rng();
+  }
+  return import_bytes(words.data(), words.size(), sizeof(uint32_t), std::endian::big);
+}
+
+// Average time of a single call of f in microseconds, repeated until the total exceeds 20ms
+template <typename F>
+double measure(F f) {
+  size_t iterations = 1;
+  while (true) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      f();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() > 20'000) {
+      return elapsed.count() / iterations;
+    }
+    iterations *= 2;
+  }
+}
@@ -1,435 +1,1478 @@
 #include "big_integer.h"
+#include "limb_division.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
 #include <ostream>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
-bool big_integer::isZero() const noexcept {
-  return data_.empty() || (data_.size() == 1 && data_.back() == 0);
-}
+#ifdef BIGINT_STATS
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
 
-big_integer::big_integer() noexcept : sign(1) {}
+namespace {
+using limb = big_integer::data_type;
+constexpr uint8_t LIMB_BITS = std::numeric_limits<limb>::digits;
 
-big_integer::big_integer(const big_integer& other) = default;
+using big_integer_detail::addInPlace;
+using big_integer_detail::divKnuth;
+using big_integer_detail::divRemSingle;
+using big_integer_detail::subMul;
 
-void big_integer::make(uint64_t value) {
-  if (value == 0) {
-    return;
+__extension__ using uint128_t = unsigned __int128;
+
+thread_local big_integer_arena* current_arena = nullptr;
+
+// numbers created while it is alive take their limbs from the heap even if an arena is active
+struct heap_scope {
+  big_integer_arena* saved;
+
+  heap_scope() noexcept : saved(std::exchange(current_arena, nullptr)) {}
+  heap_scope(const heap_scope&) = delete;
+  heap_scope& operator=(const heap_scope&) = delete;
+
+  ~heap_scope() {
+    current_arena = saved;
   }
-  while (value > 0) {
-    data_.push_back(value);
-    value >>= BITS_COUNT;
+};
+
+using stats_op = big_integer_stats::operation;
+
+#ifdef BIGINT_STATS
+struct stats_counters {
+  std::atomic<uint64_t> calls;
+  std::atomic<uint64_t> cycles;
+  std::atomic<uint64_t> allocations;
+  std::atomic<uint64_t> allocated_bytes;
+  std::atomic<uint64_t> size_histogram[big_integer_stats::HISTOGRAM_SIZE];
+};
+
+stats_counters global_stats[big_integer_stats::OPERATION_COUNT];
+stats_counters other_stats;
+// the innermost operation running on this thread
+thread_local stats_counters* current_stats = nullptr;
+
+uint64_t readCycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// counts the call of an operation when it starts and its cycles when it ends
+class stats_scope {
+public:
+  stats_scope(stats_op op, size_t size) noexcept
+      : counters_(&global_stats[static_cast<size_t>(op)]), saved_(current_stats), start_(0) {
+    if (saved_ == counters_) {
+      counters_ = nullptr;
+      return;
+    }
+    counters_->calls.fetch_add(1, std::memory_order_relaxed);
+    size_t bucket = std::min<size_t>(std::bit_width(size), big_integer_stats::HISTOGRAM_SIZE - 1);
+    counters_->size_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    current_stats = counters_;
+    start_ = readCycles();
+  }
+
+  stats_scope(const stats_scope&) = delete;
+  stats_scope& operator=(const stats_scope&) = delete;
+
+  ~stats_scope() {
+    if (counters_ != nullptr) {
+      counters_->cycles.fetch_add(readCycles() - start_, std::memory_order_relaxed);
+      current_stats = saved_;
+    }
   }
+
+private:
+  stats_counters* counters_;
+  stats_counters* saved_;
+  uint64_t start_;
+};
+
+void recordAllocation(size_t bytes) noexcept {
+  stats_counters& counters = current_stats != nullptr ? *current_stats : other_stats;
+  counters.allocations.fetch_add(1, std::memory_order_relaxed);
+  counters.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
 }
+#else
+struct stats_scope {
+  constexpr stats_scope(stats_op, size_t) noexcept {}
+};
 
-big_integer::big_integer(int a) : big_integer(static_cast<long long>(a)) {}
+void recordAllocation(size_t) noexcept {}
+#endif
 
-big_integer::big_integer(unsigned int a) : big_integer(static_cast<unsigned long long>(a)) {}
+// Work-stealing pool: every thread owns a queue, takes its newest jobs first and steals the oldest ones
+// from the others. A thread waiting for its jobs keeps running whatever it finds, so nested run calls
+// never deadlock. Jobs are executed in a heap_scope, because arenas are not shared between threads
+class thread_pool {
+public:
+  // threads counts the calling thread as well
+  explicit thread_pool(size_t threads) : queues_(threads) {
+    for (size_t slot = 1; slot < threads; ++slot) {
+      workers_.emplace_back([this, slot] { work(slot); });
+    }
+  }
 
-big_integer::big_integer(long a) : big_integer(static_cast<long long>(a)) {}
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
 
-big_integer::big_integer(unsigned long a) : big_integer(static_cast<unsigned long long>(a)) {}
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+      worker.join();
+    }
+  }
 
-big_integer::big_integer(long long a) : sign(a < 0 ? -1 : 1) {
-  uint64_t value = 0;
-  if (a < 0) {
-    if (a == std::numeric_limits<long long>::min()) {
-      value = std::numeric_limits<long long>::max();
-      value += 1;
-    } else {
-      value = -a;
+  size_t size() const noexcept {
+    return queues_.size();
+  }
+
+  // calls task(i) for every i in [0, n) and waits for all of them, the first exception is rethrown
+  void run(size_t n, const std::function<void(size_t)>& task) {
+    group owner;
+    owner.pending.store(n, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      queued_.fetch_add(n - 1, std::memory_order_relaxed);
+    }
+    {
+      queue& own = queues_[slot % queues_.size()];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      for (size_t i = n; i-- > 1;) {
+        own.jobs.push_back({&task, i, &owner});
+      }
+    }
+    wake_.notify_all();
+
+    execute({&task, 0, &owner});
+    while (owner.pending.load(std::memory_order_acquire) != 0) {
+      if (!runOne(slot % queues_.size())) {
+        std::this_thread::yield();
+      }
+    }
+    if (owner.error) {
+      std::rethrow_exception(owner.error);
     }
-  } else {
-    value = a;
   }
-  make(value);
-}
 
-big_integer::big_integer(unsigned long long a) : sign(1) {
-  make(a);
-}
+private:
+  struct group {
+    std::atomic<size_t> pending;
+    std::mutex mutex;
+    std::exception_ptr error;
+  };
 
-big_integer::big_integer(const std::string& str) : big_integer() {
-  if (str.empty() || (str.length() == 1 && str[0] == '-') || !std::all_of(str.begin() + 1, str.end(), ::isdigit) ||
-      (str[0] != '-' && !::isdigit(str[0]))) {
-    throw std::invalid_argument("biginteger can't contains non-integer values");
+  struct job {
+    const std::function<void(size_t)>* task;
+    size_t index;
+    group* owner;
+  };
+
+  struct queue {
+    std::mutex mutex;
+    std::deque<job> jobs;
+  };
+
+  // index of the queue owned by the current thread, threads outside of the pool share the first one
+  static thread_local size_t slot;
+
+  static void execute(const job& j) {
+    try {
+      heap_scope scope;
+      (*j.task)(j.index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(j.owner->mutex);
+      if (!j.owner->error) {
+        j.owner->error = std::current_exception();
+      }
+    }
+    // the group lives on the stack of run and may be gone right after this
+    j.owner->pending.fetch_sub(1, std::memory_order_release);
   }
-  size_t i = 0;
-  if (str[i] == '-') {
-    sign = -1;
-    i++;
+
+  bool runOne(size_t own) {
+    for (size_t i = 0; i < queues_.size(); ++i) {
+      queue& q = queues_[(own + i) % queues_.size()];
+      std::unique_lock<std::mutex> lock(q.mutex);
+      if (q.jobs.empty()) {
+        continue;
+      }
+      job j = (i == 0 ? q.jobs.back() : q.jobs.front());
+      if (i == 0) {
+        q.jobs.pop_back();
+      } else {
+        q.jobs.pop_front();
+      }
+      lock.unlock();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      execute(j);
+      return true;
+    }
+    return false;
   }
-  for (; i < str.length(); i += STR_NUMS_COUNT) {
-    uint32_t numbOfChars = std::min(str.length() - i, static_cast<unsigned long>(STR_NUMS_COUNT));
-    uint32_t num = std::stoi(str.substr(i, numbOfChars));
-    mulByConst(numbOfChars == STR_NUMS_COUNT ? STR_NUMS : std::pow(10, numbOfChars));
-    *this += num;
+
+  void work(size_t own) {
+    slot = own;
+    while (true) {
+      if (runOne(own)) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_relaxed) != 0; });
+      if (stop_) {
+        return;
+      }
+    }
   }
-  deleteLeadingZeroes();
+
+  std::vector<queue> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  // jobs waiting in the queues, counted before they are pushed, so it never goes below zero
+  std::atomic<size_t> queued_{0};
+  bool stop_ = false;
+};
+
+thread_local size_t thread_pool::slot = 0;
+
+// the pool is rebuilt whenever big_integer::thread_count changes
+thread_pool& sharedPool() {
+  static std::mutex mutex;
+  static std::unique_ptr<thread_pool> pool;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!pool || pool->size() != big_integer::thread_count) {
+    pool.reset();
+    pool = std::make_unique<thread_pool>(big_integer::thread_count);
+  }
+  return *pool;
 }
 
-big_integer::~big_integer() = default;
+bool parallelEnabled(bool parallel) noexcept {
+  return parallel && big_integer::thread_count > 1;
+}
 
-big_integer& big_integer::operator=(const big_integer& other) noexcept {
-  if (other == *this) {
-    return *this;
+// task(i) for every i in [0, n), spread over the pool if parallel is set and the parallel mode is on
+template <typename Task>
+void parallelFor(size_t n, bool parallel, Task&& task) {
+  if (!parallelEnabled(parallel) || n < 2) {
+    for (size_t i = 0; i < n; ++i) {
+      task(i);
+    }
+    return;
   }
-  big_integer(other).swap(*this);
-  return *this;
+  sharedPool().run(n, std::function<void(size_t)>(std::ref(task)));
 }
 
-void big_integer::swap(big_integer& other) noexcept {
-  std::swap(other.sign, sign);
-  std::swap(other.data_, data_);
+template <typename... Tasks>
+void parallelInvoke(bool parallel, Tasks&&... tasks) {
+  if (!parallelEnabled(parallel)) {
+    (tasks(), ...);
+    return;
+  }
+  std::function<void()> list[] = {std::ref(tasks)...};
+  parallelFor(sizeof...(tasks), true, [&list](size_t i) { list[i](); });
 }
 
-void big_integer::deleteLeadingZeroes() {
-  while (data_.size() > 1 && data_.back() == 0) {
-    data_.pop_back();
+limb addCarry(limb* r, size_t n, limb carry) {
+  for (size_t i = 0; i < n && carry != 0; ++i) {
+    r[i] += carry;
+    carry = (r[i] == 0);
   }
+  return carry;
 }
 
-int big_integer::normalize() {
-  int k = 0;
-  data_type back = data_.back();
-  while (back < LIMIT / 2) {
-    back <<= 1;
-    ++k;
+limb subInPlace(limb* r, const limb* a, size_t n) {
+  limb borrow = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint128_t val = static_cast<uint128_t>(r[i]) - a[i] - borrow;
+    r[i] = val;
+    borrow = (val >> LIMB_BITS) & 1;
   }
-  *this <<= k;
-  return k;
+  return borrow;
 }
 
-big_integer& big_integer::operator+=(uint64_t rhs) {
-  data_.resize(data_.size() + 1);
-  uint64_t first_val = rhs + data_[0];
-  data_[0] = first_val;
-  data_type carry = (first_val >> BITS_COUNT);
-  for (size_t i = 1; i < data_.size(); ++i) {
-    uint64_t val = static_cast<uint64_t>(data_[i]) + carry;
-    data_[i] = val;
-    carry = (val >> BITS_COUNT);
+limb subBorrow(limb* r, size_t n, limb borrow) {
+  for (size_t i = 0; i < n && borrow != 0; ++i) {
+    borrow = (r[i] == 0);
+    --r[i];
   }
-  deleteLeadingZeroes();
-  return *this;
+  return borrow;
 }
 
-void big_integer::subtract(const big_integer& rhs) {
-  bool greater = false;
-  int8_t tmp_sign = sign;
-  sign = rhs.sign;
-  if ((rhs.sign == 1 && *this < rhs) || (rhs.sign == -1 && *this > rhs)) {
-    greater = true;
-    tmp_sign = rhs.sign;
-  }
-  size_t res_size = std::max(data_.size(), rhs.data_.size()) + 1;
-  data_.resize(res_size);
-  uint64_t carry = 0;
-  for (size_t i = 0; i < res_size; ++i) {
-    uint64_t first = (i < data_.size() ? data_[i] : 0);
-    uint64_t second = (i < rhs.data_.size() ? rhs.data_[i] : 0);
-    if (greater) {
-      first = (i < rhs.data_.size() ? rhs.data_[i] : 0);
-      second = (i < data_.size() ? data_[i] : 0);
-    }
-    uint64_t res = LIMIT + first;
-    res -= carry + second;
-    data_[i] = res;
-    carry = (res >> BITS_COUNT) ^ 1;
-  }
-  sign = tmp_sign;
-  deleteLeadingZeroes();
+// r[0, n) += m for n >= 1, returns the carry out; stops at the first limb that doesn't overflow
+limb addLimb(limb* r, size_t n, limb m) {
+  r[0] += m;
+  return addCarry(r + 1, n - 1, r[0] < m);
 }
 
-big_integer& big_integer::operator+=(const big_integer& rhs) {
-  if (sign == rhs.sign) {
-    size_t res_size = std::max(data_.size(), rhs.data_.size()) + 1;
-    data_.resize(res_size);
-    size_t carry = 0;
-    for (size_t i = 0; i < res_size; ++i) {
-      size_t first = i < data_.size() ? data_[i] : 0;
-      size_t second = i < rhs.data_.size() ? rhs.data_[i] : 0;
-      size_t res = first + second + carry;
-      data_[i] = res;
-      carry = (res >> BITS_COUNT);
-    }
-    deleteLeadingZeroes();
-    return *this;
+// r[0, n) -= m for n >= 1, returns the borrow out; stops at the first limb that doesn't underflow
+limb subLimb(limb* r, size_t n, limb m) {
+  limb borrow = r[0] < m;
+  r[0] -= m;
+  return subBorrow(r + 1, n - 1, borrow);
+}
+
+// r[0, n) = a[0, n) - r[0, n), returns the borrow out
+limb subReversed(limb* r, const limb* a, size_t n) {
+  limb borrow = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint128_t val = static_cast<uint128_t>(a[i]) - r[i] - borrow;
+    r[i] = val;
+    borrow = (val >> LIMB_BITS) & 1;
   }
-  subtract(rhs);
-  return *this;
+  return borrow;
 }
 
-big_integer& big_integer::operator-=(const big_integer& rhs) {
-  int8_t tmp_sign = 0;
-  if (sign == rhs.sign) {
-    if (*this > rhs) {
-      tmp_sign = 1;
-    } else {
-      tmp_sign = -1;
+// -1, 0 or 1 as a[0, n) is less than, equal to or greater than b[0, n), looking from the top limb
+int compareLimbs(const limb* a, const limb* b, size_t n) {
+  for (size_t i = n; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
     }
-    subtract(rhs);
-  } else {
-    if (sign < rhs.sign) {
-      tmp_sign = -1;
-    } else {
-      tmp_sign = 1;
-    }
-    sign = rhs.sign;
-    *this += rhs;
   }
-  sign = tmp_sign;
-  return *this;
+  return 0;
 }
 
-void big_integer::mulByConst(const uint64_t rhs) {
-  uint64_t carry = 0;
-  data_.resize(data_.size() + 1);
-  for (data_type& i : data_) {
-    uint64_t val = i * rhs + carry;
-    i = val;
-    carry = (val >> BITS_COUNT);
+// r[0, n) += a[0, n) * m, returns the carry out
+limb addMul(limb* r, const limb* a, size_t n, limb m) {
+  limb carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint128_t val = static_cast<uint128_t>(a[i]) * m + r[i] + carry;
+    r[i] = val;
+    carry = val >> LIMB_BITS;
   }
-  deleteLeadingZeroes();
+  return carry;
 }
-big_integer& big_integer::operator*=(const big_integer& rhs) {
-  data_.insert(data_.begin(), rhs.data_.size(), 0);
-  for (size_t i = 0; i < data_.size() - rhs.data_.size(); ++i) {
-    uint64_t carry = 0;
-    uint64_t multipliyer = data_[rhs.data_.size() + i];
-    data_[rhs.data_.size() + i] = 0;
-    for (size_t j = 0; j < rhs.data_.size(); ++j) {
-      uint64_t value = multipliyer * rhs.data_[j];
-      value += data_[i + j] + carry;
-      data_[i + j] = value;
-      carry = value >> BITS_COUNT;
-    }
-    data_[rhs.data_.size() + i] = carry;
+
+void mulBasecase(limb* r, const limb* a, size_t an, const limb* b, size_t bn) {
+  std::fill(r, r + an + bn, 0);
+  for (size_t i = 0; i < bn; ++i) {
+    r[i + an] = addMul(r + i, a, an, b[i]);
   }
-  deleteLeadingZeroes();
-  sign *= rhs.sign;
-  return *this;
 }
 
-big_integer big_integer::divide(const big_integer& b) {
-  if (isZero()) {
-    return {};
-  }
-  if (b.isZero()) {
-    throw std::runtime_error("dividing by zero");
+// r[0, 2n) = a[0, n)^2, every cross product is computed once and doubled
+void sqrBasecase(limb* r, const limb* a, size_t n) {
+  std::fill(r, r + 2 * n, 0);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    r[i + n] = addMul(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
   }
-  big_integer copy_a = *this;
-  big_integer copy_b = b;
-  big_integer normalized_b = b;
-  big_integer quotient;
-  copy_a.sign = copy_b.sign = normalized_b.sign = 1;
-  size_t shift = normalized_b.normalize();
-  copy_a <<= shift;
-  if (copy_a.data_.size() < normalized_b.data_.size()) {
-    return {};
-  }
-  size_t k = copy_a.data_.size() - normalized_b.data_.size();
-  quotient.data_.resize(k + 1);
-  copy_b = normalized_b;
-  copy_b.data_.insert(copy_b.data_.begin(), k, 0);
-  if (copy_a >= copy_b) {
-    quotient.data_[k] = 1;
-    copy_a -= copy_b;
-  } else {
-    quotient.data_[k] = 0;
-  }
-  for (size_t j = k; j > 0; --j) {
-    uint64_t q_tmp = 0;
-    if (copy_a.data_.size() > 1) {
-      q_tmp = (copy_a.data_.back() * LIMIT + copy_a.data_[copy_a.data_.size() - 2]) / normalized_b.data_.back();
-    }
-    data_type q_j = std::min(q_tmp, LIMIT - 1);
-    copy_b = normalized_b;
-    copy_b.data_.insert(copy_b.data_.begin(), j - 1, 0);
-    big_integer b_mqj = copy_b;
-    b_mqj.mulByConst(q_j);
-    copy_a -= b_mqj;
-    while (copy_a < 0) {
-      --q_j;
-      copy_a += copy_b;
+  // double the cross products and add the squares in the same pass
+  limb carry = 0;
+  limb shifted = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint128_t square = static_cast<uint128_t>(a[i]) * a[i];
+    limb halves[2] = {static_cast<limb>(square), static_cast<limb>(square >> LIMB_BITS)};
+    for (size_t j = 0; j < 2; ++j) {
+      limb doubled = (r[2 * i + j] << 1) | shifted;
+      shifted = r[2 * i + j] >> (LIMB_BITS - 1);
+      uint128_t val = static_cast<uint128_t>(doubled) + halves[j] + carry;
+      r[2 * i + j] = val;
+      carry = val >> LIMB_BITS;
     }
-    quotient.data_[j - 1] = q_j;
   }
-  if (!copy_a.isZero()) {
-    copy_a >>= shift;
-  }
-  copy_a.sign = sign;
-  quotient.sign = sign * b.sign;
-  copy_a.deleteLeadingZeroes();
-  quotient.deleteLeadingZeroes();
-  *this = copy_a;
-  return quotient;
 }
 
-void big_integer::divByConst(const uint64_t rhs) {
-  std::uint64_t carry = 0;
-  for (size_t i = data_.size(); i > 0; --i) {
-    std::uint64_t curr = data_[i - 1] + carry * LIMIT;
-    data_[i - 1] = (curr / rhs);
-    carry = (curr % rhs);
+// a[0, n) = a[0, n) * m + carry, returns the carry out
+limb mulAddSingle(limb* a, size_t n, limb m, limb carry) {
+  for (size_t i = 0; i < n; ++i) {
+    uint128_t val = static_cast<uint128_t>(a[i]) * m + carry;
+    a[i] = val;
+    carry = val >> LIMB_BITS;
   }
-  deleteLeadingZeroes();
+  return carry;
 }
 
-big_integer& big_integer::operator/=(const big_integer& rhs) {
-  *this = big_integer::divide(rhs);
-  return *this;
+// writes value as exactly count decimal digits ending right before end
+void writeChunk(uint64_t value, char* end, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    *--end = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
 }
 
-big_integer& big_integer::operator%=(const big_integer& rhs) {
-  big_integer::divide(rhs);
-  return *this;
+uint64_t parseChunk(const char* first, const char* last) {
+  uint64_t value = 0;
+  for (; first != last; ++first) {
+    value = value * 10 + (*first - '0');
+  }
+  return value;
 }
 
-void big_integer::invert() {
-  if (sign > 0) {
-    return;
+// packs of limbs processed by one SSE2/AVX2 instruction through the compiler's vector extension
+#ifdef __AVX2__
+using limb_vector = limb __attribute__((vector_size(32)));
+#else
+using limb_vector = limb __attribute__((vector_size(16)));
+#endif
+constexpr size_t LIMB_VECTOR_WIDTH = sizeof(limb_vector) / sizeof(limb);
+
+// r[i] = op(r[i] ^ mask_a, b[i] ^ mask_b) ^ mask_r for i in [from, to), b == nullptr stands for zero limbs
+template <typename Operation>
+void bitwiseKernel(limb* r, const limb* b, size_t from, size_t to, limb mask_a, limb mask_b, limb mask_r,
+                   Operation op) {
+  size_t i = from;
+  for (; i + LIMB_VECTOR_WIDTH <= to; i += LIMB_VECTOR_WIDTH) {
+    limb_vector x;
+    limb_vector y{};
+    std::memcpy(&x, r + i, sizeof(x));
+    if (b != nullptr) {
+      std::memcpy(&y, b + i, sizeof(y));
+    }
+    x = op(x ^ mask_a, y ^ mask_b) ^ mask_r;
+    std::memcpy(r + i, &x, sizeof(x));
   }
-  for (data_type& i : data_) {
-    i = ~i;
+  for (; i < to; ++i) {
+    r[i] = op(r[i] ^ mask_a, (b != nullptr ? b[i] : 0) ^ mask_b) ^ mask_r;
   }
-  *this += 1;
 }
 
-void big_integer::back_invert() {
-  sign = 1;
-  *this -= 1;
-  for (data_type& i : data_) {
-    i = ~i;
+// r[0, n) = a[0, n) << shift going from the top, returns the bits shifted out; 0 < shift < LIMB_BITS, r >= a
+limb shiftLeft(limb* r, const limb* a, size_t n, unsigned shift) {
+  limb out = a[n - 1] >> (LIMB_BITS - shift);
+  size_t i = n;
+  for (; i > LIMB_VECTOR_WIDTH; i -= LIMB_VECTOR_WIDTH) {
+    limb_vector x;
+    limb_vector y;
+    std::memcpy(&x, a + i - LIMB_VECTOR_WIDTH, sizeof(x));
+    std::memcpy(&y, a + i - LIMB_VECTOR_WIDTH - 1, sizeof(y));
+    x = (x << shift) | (y >> (LIMB_BITS - shift));
+    std::memcpy(r + i - LIMB_VECTOR_WIDTH, &x, sizeof(x));
   }
-  sign = -1;
-  deleteLeadingZeroes();
+  for (; i > 1; --i) {
+    r[i - 1] = (a[i - 1] << shift) | (a[i - 2] >> (LIMB_BITS - shift));
+  }
+  r[0] = a[0] << shift;
+  return out;
 }
 
-template <typename Operation>
-void big_integer::bitwiseOp(const big_integer& other, Operation op) {
-  invert();
-  size_t beforeSize = data_.size();
-  data_.resize(std::max(data_.size(), other.data_.size()));
-  uint64_t carry = 1;
-  for (size_t i = 0; i < data_.size(); ++i) {
-    data_type first = i < beforeSize ? data_[i] : (sign < 0) ? (LIMIT - 1) : 0;
-    data_type second = i < other.data_.size() ? other.data_[i] : (sign < 0) ? (LIMIT - 1) : 0;
-    if (i < other.data_.size() && other.sign < 0) {
-      second = ~other.data_[i];
-      uint64_t with_carry = carry + second;
-      second = with_carry;
-      carry = (with_carry >> BITS_COUNT);
-    }
-    data_[i] = op(first, second);
+// r[0, n) = a[0, n) >> shift going from the bottom; 0 < shift < LIMB_BITS, r <= a
+void shiftRight(limb* r, const limb* a, size_t n, unsigned shift) {
+  size_t i = 0;
+  for (; i + LIMB_VECTOR_WIDTH < n; i += LIMB_VECTOR_WIDTH) {
+    limb_vector x;
+    limb_vector y;
+    std::memcpy(&x, a + i, sizeof(x));
+    std::memcpy(&y, a + i + 1, sizeof(y));
+    x = (x >> shift) | (y << (LIMB_BITS - shift));
+    std::memcpy(r + i, &x, sizeof(x));
   }
-  deleteLeadingZeroes();
+  for (; i + 1 < n; ++i) {
+    r[i] = (a[i] >> shift) | (a[i + 1] << (LIMB_BITS - shift));
+  }
+  r[n - 1] = a[n - 1] >> shift;
 }
 
-big_integer& big_integer::operator&=(const big_integer& rhs) {
-  bitwiseOp(rhs, std::bit_and<>());
-  if (sign < 0 && rhs.sign < 0) {
-    back_invert();
-  } else if (sign < 0 && rhs.sign > 0) {
-    sign = 1;
+// r[0, rn) += x * 2^(LIMB_BITS * offset); x has to fit into r after the shift
+void addShifted(limb* r, size_t rn, const limb* x, size_t xn, size_t offset) {
+  while (xn > 0 && offset + xn > rn) {
+    --xn;
   }
-  return *this;
+  limb carry = addInPlace(r + offset, x, xn);
+  addCarry(r + offset + xn, rn - offset - xn, carry);
 }
 
-big_integer& big_integer::operator|=(const big_integer& rhs) {
-  bitwiseOp(rhs, std::bit_or<>());
-  if (sign < 0 || rhs.sign < 0) {
-    back_invert();
+// Arithmetic modulo an NTT-friendly prime below 2^62, products are computed in Montgomery form with R = 2^64
+struct ntt_prime {
+  uint64_t mod;
+  uint64_t root;
+  uint64_t neg_inv;
+  uint64_t r2;
+
+  constexpr ntt_prime(uint64_t mod_, uint64_t root_) : mod(mod_), root(root_), neg_inv(mod_), r2(0) {
+    for (int i = 0; i < 5; ++i) {
+      neg_inv *= 2 - mod * neg_inv;
+    }
+    neg_inv = -neg_inv;
+    uint64_t r = -mod % mod;
+    r2 = static_cast<uint128_t>(r) * r % mod;
   }
-  return *this;
-}
 
-big_integer& big_integer::operator^=(const big_integer& rhs) {
-  bitwiseOp(rhs, std::bit_xor<>());
-  if ((sign < 0 && rhs.sign > 0) || (sign > 0 && rhs.sign < 0)) {
-    back_invert();
-  } else if (sign == rhs.sign) {
-    sign = 1;
+  uint64_t reduce(uint128_t value) const {
+    uint64_t m = static_cast<uint64_t>(value) * neg_inv;
+    uint64_t res = (value + static_cast<uint128_t>(m) * mod) >> 64;
+    return res >= mod ? res - mod : res;
+  }
+
+  // a * b / R
+  uint64_t mul(uint64_t a, uint64_t b) const {
+    return reduce(static_cast<uint128_t>(a) * b);
+  }
+
+  uint64_t add(uint64_t a, uint64_t b) const {
+    uint64_t res = a + b;
+    return res >= mod ? res - mod : res;
+  }
+
+  uint64_t sub(uint64_t a, uint64_t b) const {
+    return a >= b ? a - b : a + mod - b;
+  }
+
+  uint64_t toMontgomery(uint64_t a) const {
+    return mul(a, r2);
+  }
+
+  // base and result are in Montgomery form
+  uint64_t pow(uint64_t base, uint64_t exp) const {
+    uint64_t res = toMontgomery(1);
+    for (; exp > 0; exp >>= 1) {
+      if (exp & 1) {
+        res = mul(res, base);
+      }
+      base = mul(base, base);
+    }
+    return res;
+  }
+
+  // roots[len + j] = w^j for every power of two len < n, where w is the primitive root of unity of degree 2 * len
+  std::vector<uint64_t> roots(size_t n, bool inverse) const {
+    std::vector<uint64_t> res(n);
+    for (size_t len = 1; len < n; len *= 2) {
+      uint64_t exp = (mod - 1) / (2 * len);
+      uint64_t w = pow(toMontgomery(root), inverse ? mod - 1 - exp : exp);
+      res[len] = toMontgomery(1);
+      for (size_t j = 1; j < len; ++j) {
+        res[len + j] = mul(res[len + j - 1], w);
+      }
+    }
+    return res;
+  }
+
+  // decimation in frequency, the result is in bit-reversed order
+  void forward(uint64_t* a, size_t n, const uint64_t* w) const {
+    for (size_t len = n / 2; len > 0; len /= 2) {
+      for (size_t i = 0; i < n; i += 2 * len) {
+        for (size_t j = 0; j < len; ++j) {
+          uint64_t u = a[i + j];
+          uint64_t v = a[i + j + len];
+          a[i + j] = add(u, v);
+          a[i + j + len] = mul(sub(u, v), w[len + j]);
+        }
+      }
+    }
+  }
+
+  // decimation in time from bit-reversed order, the result is scaled by n
+  void inverse(uint64_t* a, size_t n, const uint64_t* w) const {
+    for (size_t len = 1; len < n; len *= 2) {
+      for (size_t i = 0; i < n; i += 2 * len) {
+        for (size_t j = 0; j < len; ++j) {
+          uint64_t u = a[i + j];
+          uint64_t v = mul(a[i + j + len], w[len + j]);
+          a[i + j] = add(u, v);
+          a[i + j + len] = sub(u, v);
+        }
+      }
+    }
+  }
+
+  // computes the cyclic convolution of fa and fb into fa, fb is ignored for squaring
+  void convolve(uint64_t* fa, uint64_t* fb, size_t n, bool square) const {
+    std::vector<uint64_t> w = roots(n, false);
+    forward(fa, n, w.data());
+    if (square) {
+      for (size_t i = 0; i < n; ++i) {
+        fa[i] = mul(fa[i], fa[i]);
+      }
+    } else {
+      forward(fb, n, w.data());
+      for (size_t i = 0; i < n; ++i) {
+        fa[i] = mul(fa[i], fb[i]);
+      }
+    }
+    w = roots(n, true);
+    inverse(fa, n, w.data());
+    // pointwise products carry an extra 1 / R, this multiplies by R / n
+    uint64_t scale = mul(pow(toMontgomery(n), mod - 2), r2);
+    for (size_t i = 0; i < n; ++i) {
+      fa[i] = mul(fa[i], scale);
+    }
+  }
+};
+
+constexpr ntt_prime NTT_PRIMES[] = {
+    {29 * (1ULL << 57) + 1, 3},
+    {69 * (1ULL << 55) + 1, 5},
+    {127 * (1ULL << 54) + 1, 3},
+};
+
+// Exact product through three modular convolutions glued by the Chinese remainder theorem. Limbs are split
+// into 32-bit digits, so every coefficient is below 2^64 * n, which is far less than the product of the primes
+void mulNtt(limb* r, const limb* a, size_t an, const limb* b, size_t bn, bool square) {
+  const ntt_prime& p1 = NTT_PRIMES[0];
+  const ntt_prime& p2 = NTT_PRIMES[1];
+  const ntt_prime& p3 = NTT_PRIMES[2];
+  static const uint64_t p1_inv_mod_p2 = p2.pow(p2.toMontgomery(p1.mod % p2.mod), p2.mod - 2);
+  static const uint64_t p1_mod_p3 = p3.toMontgomery(p1.mod % p3.mod);
+  static const uint64_t p12_inv_mod_p3 = p3.pow(p3.mul(p1_mod_p3, p3.toMontgomery(p2.mod)), p3.mod - 2);
+
+  constexpr size_t DIGITS = LIMB_BITS / 32;
+  auto split = [](const limb* x, size_t xn, uint64_t* out) {
+    for (size_t i = 0; i < xn * DIGITS; ++i) {
+      out[i] = static_cast<uint32_t>(x[i / DIGITS] >> (i % DIGITS * 32));
+    }
+  };
+
+  size_t n = std::bit_ceil((an + bn) * DIGITS);
+  std::vector<uint64_t> fa(3 * n);
+  std::vector<uint64_t> fb(square ? 0 : 3 * n);
+  parallelFor(3, bn >= big_integer::parallel_threshold, [&](size_t k) {
+    split(a, an, fa.data() + k * n);
+    if (!square) {
+      split(b, bn, fb.data() + k * n);
+    }
+    NTT_PRIMES[k].convolve(fa.data() + k * n, square ? nullptr : fb.data() + k * n, n, square);
+  });
+
+  // the 192-bit carry is kept as low 128 bits plus the high word
+  uint128_t carry_low = 0;
+  uint64_t carry_high = 0;
+  std::fill(r, r + an + bn, 0);
+  for (size_t i = 0; i < (an + bn) * DIGITS; ++i) {
+    uint64_t r1 = fa[i];
+    uint64_t r2 = fa[n + i];
+    uint64_t r3 = fa[2 * n + i];
+    uint64_t t2 = p2.mul(p2.sub(r2, r1 % p2.mod), p1_inv_mod_p2);
+    uint64_t x12_mod_p3 = p3.add(r1 % p3.mod, p3.mul(t2 % p3.mod, p1_mod_p3));
+    uint64_t t3 = p3.mul(p3.sub(r3, x12_mod_p3), p12_inv_mod_p3);
+
+    // x = r1 + p1 * t2 + p1 * p2 * t3
+    uint128_t low = r1 + static_cast<uint128_t>(p1.mod) * t2;
+    uint128_t p12 = static_cast<uint128_t>(p1.mod) * p2.mod;
+    uint128_t mid = static_cast<uint128_t>(static_cast<uint64_t>(p12)) * t3;
+    uint128_t high = static_cast<uint128_t>(static_cast<uint64_t>(p12 >> 64)) * t3 + (mid >> 64);
+    uint128_t x_low = (high << 64) + static_cast<uint64_t>(mid);
+    uint64_t x_high = high >> 64;
+    x_low += low;
+    x_high += (x_low < low);
+
+    carry_low += x_low;
+    carry_high += x_high + (carry_low < x_low);
+    r[i / DIGITS] |= static_cast<limb>(static_cast<uint32_t>(carry_low)) << (i % DIGITS * 32);
+    carry_low = (carry_low >> 32) | (static_cast<uint128_t>(carry_high) << 96);
+    carry_high >>= 32;
   }
-  return *this;
 }
 
-big_integer& big_integer::operator<<=(int rhs) {
-  uint32_t shiftAbs = rhs / BITS_COUNT;
-  data_.insert(data_.begin(), shiftAbs, 0);
-  rhs %= BITS_COUNT;
-  uint32_t value = 1 << rhs;
-  mulByConst(value);
-  return *this;
+// -m^-1 mod B for an odd m by Newton's iteration, every step doubles the number of correct low bits
+limb montgomeryInverse(limb m) {
+  limb x = m;
+  for (int i = 0; i < 5; ++i) {
+    x *= 2 - m * x;
+  }
+  return -x;
 }
 
-big_integer& big_integer::operator>>=(int rhs) {
-  uint32_t shiftAbs = std::min(1UL * rhs / BITS_COUNT, data_.size());
-  data_.erase(data_.begin(), data_.begin() + shiftAbs);
-  if (data_.empty()) {
-    *this = big_integer();
-    return *this;
+// Montgomery reduction of t[0, 2n) < m * B^n: r[0, n) = t / B^n mod m, t is destroyed.
+// inv is -m^-1 mod B, r may alias neither t nor m
+void montgomeryReduce(limb* r, limb* t, const limb* m, size_t n, limb inv) {
+  limb extra = 0;
+  for (size_t i = 0; i < n; ++i) {
+    limb carry = addMul(t + i, m, n, t[i] * inv);
+    uint128_t val = static_cast<uint128_t>(t[i + n]) + carry + extra;
+    t[i + n] = val;
+    extra = val >> LIMB_BITS;
   }
-  rhs %= BITS_COUNT;
-  uint32_t value = (1 << rhs);
-  divByConst(value);
-  if (sign == -1) {
-    *this += 1;
+  // the result is below 2m, so at most one subtraction is needed
+  size_t i = n;
+  while (i > 0 && t[n + i - 1] == m[i - 1]) {
+    --i;
   }
-  return *this;
+  if (extra != 0 || i == 0 || t[n + i - 1] > m[i - 1]) {
+    subInPlace(t + n, m, n);
+  }
+  std::copy(t + n, t + 2 * n, r);
 }
 
-big_integer big_integer::operator+() const noexcept {
-  return *this;
+// arena allocations are rounded up to 2^k + (j + 1) * 2^(k - 2) bytes, class 4k + j for j < 4
+size_t arenaSizeClass(size_t bytes) {
+  // more than 4 limbs, so that every size of a class is a multiple of the limb size
+  bytes = std::max(bytes, 4 * sizeof(limb) + 1);
+  size_t k = std::bit_width(bytes - 1) - 1;
+  return 4 * k + ((bytes - 1) >> (k - 2)) - 4;
 }
 
-big_integer big_integer::operator-() const noexcept {
-  big_integer tmp = *this;
-  tmp.sign = -sign;
-  return tmp;
+size_t arenaClassSize(size_t size_class) {
+  return (4 + size_class % 4 + 1) << (size_class / 4 - 2);
 }
+} // namespace
 
-big_integer big_integer::operator~() const {
-  big_integer copy = *this;
-  copy.sign = -sign;
-  copy += 1;
-  return copy;
+size_t big_integer::karatsuba_threshold = 32;
+size_t big_integer::toom3_threshold = 700;
+size_t big_integer::ntt_threshold = 11000;
+size_t big_integer::newton_threshold = 5000;
+size_t big_integer::hgcd_threshold = 200;
+size_t big_integer::thread_count = 1;
+size_t big_integer::parallel_threshold = 1500;
+
+big_integer::limb_storage::limb_storage() noexcept : size_(0), capacity_(SMALL_SIZE), arena_(current_arena) {}
+
+big_integer::limb_storage::limb_storage(const limb_storage& other) : limb_storage() {
+  // a spare limb for the carry of long numbers, copies are mostly made to add to or shift them
+  if (other.size_ > SMALL_SIZE) {
+    reserve(other.size_ + 1);
+  }
+  assign(other.begin(), other.end());
 }
 
-big_integer& big_integer::operator++() {
-  *this += 1;
-  return *this;
+// takes the limbs together with their arena, so that a move never allocates and a number moved while some
+// other arena is active stays where it was
+big_integer::limb_storage::limb_storage(limb_storage&& other) noexcept
+    : size_(other.size_), capacity_(other.capacity_), buffer_(other.buffer_), arena_(other.arena_) {
+  other.size_ = 0;
+  other.capacity_ = SMALL_SIZE;
 }
 
-big_integer big_integer::operator++(int) {
-  big_integer tmp = *this;
-  ++*this;
-  return tmp;
+big_integer::limb_storage& big_integer::limb_storage::operator=(const limb_storage& other) {
+  if (this != &other) {
+    assign(other.begin(), other.end());
+  }
+  return *this;
 }
 
-big_integer& big_integer::operator--() {
-  *this -= 1;
+big_integer::limb_storage& big_integer::limb_storage::operator=(limb_storage&& other) {
+  if (arena_ == other.arena_) {
+    swap(other);
+  } else {
+    assign(other.begin(), other.end());
+  }
   return *this;
 }
 
-big_integer big_integer::operator--(int) {
-  big_integer tmp = *this;
-  --*this;
-  return tmp;
+big_integer::limb_storage::~limb_storage() {
+  if (!isSmall()) {
+    release();
+  }
 }
 
-big_integer operator+(const big_integer& a, const big_integer& b) {
-  big_integer out = a;
-  out += b;
-  return out;
+void big_integer::limb_storage::release() noexcept {
+  if (isBorrowed()) {
+    return;
+  }
+  if (arena_ == nullptr) {
+    delete[] buffer_.big_data_;
+  } else {
+    arena_->deallocate(buffer_.big_data_, capacity_ * sizeof(data_type));
+  }
 }
 
-big_integer operator-(const big_integer& a, const big_integer& b) {
-  big_integer out = a;
-  out -= b;
-  return out;
+void big_integer::limb_storage::reserve(size_t capacity) {
+  if (capacity <= capacity_) {
+    return;
+  }
+  if (capacity > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("big_integer is too long");
+  }
+  data_type* new_data = arena_ == nullptr ? new data_type[capacity]
+                                          : static_cast<data_type*>(arena_->allocate(capacity * sizeof(data_type)));
+  recordAllocation(capacity * sizeof(data_type));
+  std::copy_n(data(), size_, new_data);
+  if (!isSmall()) {
+    release();
+  }
+  buffer_.big_data_ = new_data;
+  capacity_ = capacity;
+}
+
+void big_integer::limb_storage::resize(size_t size) {
+  if (size > capacity_) {
+    reserve(std::max(size, 2 * static_cast<size_t>(capacity_)));
+  }
+  if (size > size_) {
+    std::fill(data() + size_, data() + size, 0);
+  }
+  size_ = size;
+}
+
+void big_integer::limb_storage::assign(size_t count, data_type value) {
+  size_ = 0;
+  reserve(count);
+  std::fill_n(data(), count, value);
+  size_ = count;
+}
+
+void big_integer::limb_storage::assign(const data_type* first, const data_type* last) {
+  size_ = 0;
+  reserve(last - first);
+  size_ = std::copy(first, last, data()) - data();
+}
+
+void big_integer::limb_storage::swap(limb_storage& other) {
+  if (arena_ != other.arena_) {
+    // limbs never move to a storage of another arena, they are copied
+    limb_storage tmp(other);
+    other.assign(begin(), end());
+    assign(tmp.begin(), tmp.end());
+    return;
+  }
+  std::swap(size_, other.size_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(buffer_, other.buffer_);
+}
+
+void big_integer::limb_storage::borrow(const data_type* limbs, size_t size) noexcept {
+  if (!isSmall()) {
+    release();
+  }
+  buffer_.big_data_ = const_cast<data_type*>(limbs);
+  size_ = size;
+  capacity_ = 0;
+}
+
+bool big_integer::isZero() const noexcept {
+  return data_.empty() || (data_.size() == 1 && data_.back() == 0);
+}
+
+big_integer::big_integer() noexcept : sign(1) {}
+
+big_integer::big_integer(const big_integer& other) = default;
+
+big_integer::big_integer(big_integer&& other) noexcept : data_(std::move(other.data_)), sign(other.sign) {}
+
+void big_integer::make(uint64_t value) {
+  if (value != 0) {
+    data_.push_back(value);
+  }
+}
+
+big_integer::big_integer(int a) : big_integer(static_cast<long long>(a)) {}
+
+big_integer::big_integer(unsigned int a) : big_integer(static_cast<unsigned long long>(a)) {}
+
+big_integer::big_integer(long a) : big_integer(static_cast<long long>(a)) {}
+
+big_integer::big_integer(unsigned long a) : big_integer(static_cast<unsigned long long>(a)) {}
+
+big_integer::big_integer(long long a) : sign(a < 0 ? -1 : 1) {
+  uint64_t value = 0;
+  if (a < 0) {
+    if (a == std::numeric_limits<long long>::min()) {
+      value = std::numeric_limits<long long>::max();
+      value += 1;
+    } else {
+      value = -a;
+    }
+  } else {
+    value = a;
+  }
+  make(value);
+}
+
+big_integer::big_integer(unsigned long long a) : sign(1) {
+  make(a);
+}
+
+big_integer::big_integer(const std::string& str) : big_integer() {
+  stats_scope stats(stats_op::from_string, (str.length() + STR_NUMS_COUNT - 1) / STR_NUMS_COUNT);
+  if (str.empty() || (str.length() == 1 && str[0] == '-') || !std::all_of(str.begin() + 1, str.end(), ::isdigit) ||
+      (str[0] != '-' && !::isdigit(str[0]))) {
+    throw std::invalid_argument("biginteger can't contains non-integer values");
+  }
+  size_t i = (str[0] == '-' ? 1 : 0);
+  parseDigits(str.data() + i, str.length() - i).swap(*this);
+  sign = (i == 1 ? -1 : 1);
+}
+
+big_integer::~big_integer() = default;
+
+big_integer& big_integer::operator=(const big_integer& other) noexcept {
+  data_ = other.data_;
+  sign = other.sign;
+  return *this;
+}
+
+big_integer& big_integer::operator=(big_integer&& other) {
+  swap(other);
+  return *this;
+}
+
+void big_integer::swap(big_integer& other) {
+  std::swap(other.sign, sign);
+  data_.swap(other.data_);
+}
+
+void big_integer::deleteLeadingZeroes() {
+  while (data_.size() > 1 && data_.back() == 0) {
+    data_.pop_back();
+  }
+}
+
+void big_integer::addSmall(uint64_t value, int8_t value_sign) {
+  stats_scope stats(stats_op::add, data_.size());
+  if (value == 0) {
+    return;
+  }
+  if (isZero()) {
+    data_.resize(1);
+    data_[0] = value;
+    sign = value_sign;
+  } else if (sign == value_sign) {
+    limb carry = addLimb(data_.data(), data_.size(), value);
+    if (carry != 0) {
+      data_.push_back(carry);
+    }
+  } else if (data_.size() == 1 && data_[0] < value) {
+    data_[0] = value - data_[0];
+    sign = value_sign;
+  } else {
+    subLimb(data_.data(), data_.size(), value);
+    deleteLeadingZeroes();
+  }
+}
+
+int big_integer::compareMagnitude(const big_integer& rhs) const noexcept {
+  size_t an = isZero() ? 0 : data_.size();
+  size_t bn = rhs.isZero() ? 0 : rhs.data_.size();
+  if (an != bn) {
+    return an < bn ? -1 : 1;
+  }
+  return compareLimbs(data_.data(), rhs.data_.data(), an);
+}
+
+void big_integer::addMagnitude(const big_integer& rhs) {
+  size_t bn = rhs.data_.size();
+  if (data_.size() < bn) {
+    data_.resize(bn);
+  }
+  // rhs may be *this, so its limbs are only looked at after the resize
+  limb carry = addCarry(data_.data() + bn, data_.size() - bn, addInPlace(data_.data(), rhs.data_.data(), bn));
+  if (carry != 0) {
+    data_.push_back(carry);
+  }
+}
+
+void big_integer::subtract(const big_integer& rhs, int8_t rhs_sign) {
+  if (rhs.isZero()) {
+    return;
+  }
+  size_t bn = rhs.data_.size();
+  if (compareMagnitude(rhs) >= 0) {
+    subBorrow(data_.data() + bn, data_.size() - bn, subInPlace(data_.data(), rhs.data_.data(), bn));
+  } else {
+    data_.resize(bn);
+    subReversed(data_.data(), rhs.data_.data(), bn);
+    sign = rhs_sign;
+  }
+  deleteLeadingZeroes();
+}
+
+big_integer& big_integer::operator+=(const big_integer& rhs) {
+  stats_scope stats(stats_op::add, std::max(data_.size(), rhs.data_.size()));
+  if (sign == rhs.sign) {
+    addMagnitude(rhs);
+  } else {
+    subtract(rhs, rhs.sign);
+  }
+  return *this;
+}
+
+big_integer& big_integer::operator-=(const big_integer& rhs) {
+  stats_scope stats(stats_op::subtract, std::max(data_.size(), rhs.data_.size()));
+  if (sign != rhs.sign) {
+    addMagnitude(rhs);
+  } else {
+    subtract(rhs, -rhs.sign);
+  }
+  return *this;
+}
+
+void big_integer::mulMagnitude(data_type* r, const data_type* a, size_t an, const data_type* b, size_t bn) {
+  if (an < bn) {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+  if (bn == 0) {
+    std::fill(r, r + an, 0);
+  } else if (bn < std::max<size_t>(karatsuba_threshold, 4)) {
+    if (a == b && an == bn) {
+      sqrBasecase(r, a, an);
+    } else {
+      mulBasecase(r, a, an, b, bn);
+    }
+  } else if (bn >= ntt_threshold) {
+    mulNtt(r, a, an, b, bn, a == b || (an == bn && std::equal(a, a + an, b)));
+  } else if (an >= 2 * bn) {
+    std::fill(r, r + an + bn, 0);
+    std::vector<data_type> chunk(2 * bn);
+    for (size_t i = 0; i < an; i += bn) {
+      size_t len = std::min(bn, an - i);
+      mulMagnitude(chunk.data(), a + i, len, b, bn);
+      addShifted(r, an + bn, chunk.data(), len + bn, i);
+    }
+  } else if (bn < toom3_threshold) {
+    mulKaratsuba(r, a, an, b, bn);
+  } else {
+    mulToom3(r, a, an, b, bn);
+  }
+}
+
+void big_integer::mulKaratsuba(data_type* r, const data_type* a, size_t an, const data_type* b, size_t bn) {
+  size_t m = (an + 1) / 2;
+  if (bn <= m) {
+    std::vector<data_type> high(an - m + bn);
+    std::fill(r + m + bn, r + an + bn, 0);
+    parallelInvoke(
+        bn >= parallel_threshold, [&] { mulMagnitude(r, a, m, b, bn); },
+        [&] { mulMagnitude(high.data(), a + m, an - m, b, bn); });
+    addShifted(r, an + bn, high.data(), high.size(), m);
+    return;
+  }
+  std::vector<data_type> buf(4 * m + 4);
+  data_type* sum_a = buf.data();
+  data_type* sum_b = sum_a + m + 1;
+  data_type* middle = sum_b + m + 1;
+
+  std::copy(a, a + m, sum_a);
+  sum_a[m] = addCarry(sum_a + an - m, 2 * m - an, addInPlace(sum_a, a + m, an - m));
+  std::copy(b, b + m, sum_b);
+  sum_b[m] = addCarry(sum_b + bn - m, 2 * m - bn, addInPlace(sum_b, b + m, bn - m));
+
+  parallelInvoke(
+      m >= parallel_threshold, [&] { mulMagnitude(middle, sum_a, m + 1, a == b ? sum_a : sum_b, m + 1); },
+      [&] { mulMagnitude(r, a, m, b, m); }, [&] { mulMagnitude(r + 2 * m, a + m, an - m, b + m, bn - m); });
+
+  size_t high_size = an + bn - 2 * m;
+  subBorrow(middle + 2 * m, 2, subInPlace(middle, r, 2 * m));
+  subBorrow(middle + high_size, 2 * m + 2 - high_size, subInPlace(middle, r + 2 * m, high_size));
+  addShifted(r, an + bn, middle, 2 * m + 2, m);
+}
+
+void big_integer::mulToom3(data_type* r, const data_type* a, size_t an, const data_type* b, size_t bn) {
+  size_t k = (an + 2) / 3;
+  if (bn <= 2 * k) {
+    mulKaratsuba(r, a, an, b, bn);
+    return;
+  }
+  auto piece = [k](const data_type* x, size_t n, size_t i) {
+    return fromLimbs(x + std::min(n, i * k), std::min(n, (i + 1) * k) - std::min(n, i * k));
+  };
+  big_integer a0 = piece(a, an, 0), a1 = piece(a, an, 1), a2 = piece(a, an, 2);
+  big_integer b0 = piece(b, bn, 0), b1 = piece(b, bn, 1), b2 = piece(b, bn, 2);
+
+  // evaluation at 0, 1, -1, -2 and infinity
+  big_integer pa = a0 + a2, pb = b0 + b2;
+  big_integer pa1 = pa + a1, pb1 = pb + b1;
+  big_integer pam1 = pa - a1, pbm1 = pb - b1;
+  big_integer pam2 = ((pam1 + a2) <<= 1) - a0;
+  big_integer pbm2 = ((pbm1 + b2) <<= 1) - b0;
+
+  // the products are born inside the tasks, so that no limbs of the caller's arena are touched by the pool;
+  // a square multiplies every point by itself and reaches the squaring kernels
+  bool square = a == b && an == bn;
+  const big_integer* factors[][2] = {{&a0, square ? &a0 : &b0},
+                                     {&pa1, square ? &pa1 : &pb1},
+                                     {&pam1, square ? &pam1 : &pbm1},
+                                     {&pam2, square ? &pam2 : &pbm2},
+                                     {&a2, square ? &a2 : &b2}};
+  std::optional<big_integer> products[5];
+  parallelFor(5, k >= parallel_threshold, [&](size_t i) { products[i].emplace(*factors[i][0] * *factors[i][1]); });
+  big_integer& r0 = *products[0];
+  big_integer& r1 = *products[1];
+  big_integer& rm1 = *products[2];
+  big_integer& rm2 = *products[3];
+  big_integer& rinf = *products[4];
+
+  // Bodrato's interpolation sequence, every division is exact
+  big_integer c3 = rm2 - r1;
+  c3.divByConst(3);
+  big_integer c1 = r1 - rm1;
+  c1.divByConst(2);
+  big_integer c2 = rm1 - r0;
+  c3 = c2 - c3;
+  c3.divByConst(2);
+  c3 += rinf << 1;
+  c2 += c1;
+  c2 -= rinf;
+  c1 -= c3;
+
+  size_t rn = an + bn;
+  std::fill(r, r + rn, 0);
+  addShifted(r, rn, r0.data_.data(), r0.data_.size(), 0);
+  addShifted(r, rn, c1.data_.data(), c1.data_.size(), k);
+  addShifted(r, rn, c2.data_.data(), c2.data_.size(), 2 * k);
+  addShifted(r, rn, c3.data_.data(), c3.data_.size(), 3 * k);
+  addShifted(r, rn, rinf.data_.data(), rinf.data_.size(), 4 * k);
+}
+
+big_integer& big_integer::operator*=(const big_integer& rhs) {
+  stats_scope stats(stats_op::multiply, std::min(data_.size(), rhs.data_.size()));
+  if (isZero() || rhs.isZero()) {
+    *this = big_integer();
+    return *this;
+  }
+  limb_storage res;
+  res.resize(data_.size() + rhs.data_.size());
+  mulMagnitude(res.data(), data_.data(), data_.size(), rhs.data_.data(), rhs.data_.size());
+  data_ = std::move(res);
+  deleteLeadingZeroes();
+  sign *= rhs.sign;
+  return *this;
+}
+
+void big_integer::addProduct(const big_integer& a, const big_integer& b, int8_t product_sign) {
+  stats_scope stats(stats_op::multiply, std::min(a.data_.size(), b.data_.size()));
+  if (a.isZero() || b.isZero()) {
+    return;
+  }
+  if (this == &a || this == &b) {
+    big_integer product = a * b;
+    product.sign = product_sign;
+    *this += product;
+    return;
+  }
+  if (isZero()) {
+    sign = product_sign;
+  }
+  bool subtract = sign != product_sign;
+  const data_type* x = a.data_.data();
+  const data_type* y = b.data_.data();
+  size_t xn = a.data_.size();
+  size_t yn = b.data_.size();
+  if (xn < yn) {
+    std::swap(x, y);
+    std::swap(xn, yn);
+  }
+  size_t n = std::max(data_.size(), xn + yn) + 1;
+  data_.resize(n);
+  data_type* r = data_.data();
+  data_type overflow = 0;
+  if (yn < std::max<size_t>(karatsuba_threshold, 4)) {
+    // one row of the schoolbook product per limb of y, carries go straight into r
+    for (size_t i = 0; i < yn; ++i) {
+      data_type* row = r + i;
+      data_type top = row[xn];
+      if (subtract) {
+        data_type borrow = subMul(row, x, xn, y[i]);
+        row[xn] -= borrow;
+        overflow |= subBorrow(row + xn + 1, n - i - xn - 1, top < borrow);
+      } else {
+        data_type carry = addMul(row, x, xn, y[i]);
+        row[xn] += carry;
+        addCarry(row + xn + 1, n - i - xn - 1, row[xn] < carry);
+      }
+    }
+  } else {
+    limb_storage product;
+    product.resize(xn + yn);
+    mulMagnitude(product.data(), x, xn, y, yn);
+    if (subtract) {
+      overflow = subBorrow(r + xn + yn, n - xn - yn, subInPlace(r, product.data(), xn + yn));
+    } else {
+      addCarry(r + xn + yn, n - xn - yn, addInPlace(r, product.data(), xn + yn));
+    }
+  }
+  if (overflow != 0) {
+    // |product| > |*this|, the limbs hold B^n - |result|
+    for (size_t i = 0; i < n; ++i) {
+      r[i] = ~r[i];
+    }
+    addCarry(r, n, 1);
+    sign = product_sign;
+  }
+  deleteLeadingZeroes();
+}
+
+big_integer big_integer::fromLimbs(const data_type* first, size_t n) {
+  big_integer res;
+  res.data_.assign(first, first + n);
+  res.deleteLeadingZeroes();
+  return res;
+}
+
+big_integer big_integer::reciprocal(const big_integer& v, size_t n) {
+  big_integer power = big_integer(1) << static_cast<int>(2 * n * BITS_COUNT);
+  if (n < std::max<size_t>(newton_threshold, 2)) {
+    return power / v;
+  }
+  // Newton iteration x += x * (B^2n - v * x) / B^2n from the reciprocal of the top half,
+  // every step doubles the number of correct limbs
+  size_t h = (n + 1) / 2;
+  big_integer x = reciprocal(v >> static_cast<int>((n - h) * BITS_COUNT), h) << static_cast<int>((n - h) * BITS_COUNT);
+  x += (x * (power - v * x)) >> static_cast<int>(2 * n * BITS_COUNT);
+  big_integer rem = power - v * x;
+  while (rem.sign < 0 && !rem.isZero()) {
+    x -= 1;
+    rem += v;
+  }
+  while (rem >= v) {
+    x += 1;
+    rem -= v;
+  }
+  return x;
+}
+
+void big_integer::divNewton(data_type* q, data_type* u, size_t un, const data_type* v, size_t n) {
+  big_integer divisor = fromLimbs(v, n);
+  big_integer inverse = reciprocal(divisor, n);
+  big_integer rem;
+  std::fill(q, q + un - n, 0);
+  // long division by the "digit" B^n, each step is a Barrett reduction of a number below v * B^n
+  for (size_t i = (un + n - 1) / n; i-- > 0;) {
+    size_t from = i * n;
+    rem <<= static_cast<int>(n * BITS_COUNT);
+    rem += fromLimbs(u + from, std::min(un, from + n) - from);
+    big_integer digit = rem >> static_cast<int>((n - 1) * BITS_COUNT);
+    digit *= inverse;
+    digit >>= static_cast<int>((n + 1) * BITS_COUNT);
+    rem -= digit * divisor;
+    while (rem >= divisor) {
+      rem -= divisor;
+      digit += 1;
+    }
+    std::copy_n(digit.data_.begin(), std::min(digit.data_.size(), un - n - std::min(from, un - n)), q + from);
+  }
+  std::fill(u, u + un, 0);
+  std::copy(rem.data_.begin(), rem.data_.end(), u);
+}
+
+big_integer big_integer::divide(const big_integer& b) {
+  stats_scope stats(stats_op::divide, b.data_.size());
+  if (b.isZero()) {
+    throw std::runtime_error("dividing by zero");
+  }
+  big_integer quotient;
+  size_t an = data_.size();
+  size_t bn = b.data_.size();
+  if (isZero() || an < bn) {
+    return quotient;
+  }
+  quotient.sign = sign * b.sign;
+  if (bn == 1) {
+    // b may be *this, whose limbs are about to move into the quotient
+    limb divisor = b.data_[0];
+    quotient.data_.swap(data_);
+    data_.assign(1, divRemSingle(quotient.data_.data(), an, divisor));
+  } else {
+    int shift = std::countl_zero(b.data_.back());
+    limb_storage v(b.data_);
+    data_.push_back(0);
+    if (shift != 0) {
+      shiftLeft(v.data(), v.data(), bn, shift);
+      data_[an] = shiftLeft(data_.data(), data_.data(), an, shift);
+    }
+    quotient.data_.resize(an - bn + 1);
+    if (bn >= newton_threshold && an - bn >= newton_threshold) {
+      divNewton(quotient.data_.data(), data_.data(), an + 1, v.data(), bn);
+    } else {
+      divKnuth(quotient.data_.data(), data_.data(), an + 1, v.data(), bn);
+    }
+    data_.resize(bn);
+    if (shift != 0) {
+      shiftRight(data_.data(), data_.data(), bn, shift);
+    }
+  }
+  deleteLeadingZeroes();
+  quotient.deleteLeadingZeroes();
+  return quotient;
+}
+
+void big_integer::divByConst(const uint64_t rhs) {
+  divRemSingle(data_.data(), data_.size(), rhs);
+  deleteLeadingZeroes();
+}
+
+big_integer& big_integer::operator/=(const big_integer& rhs) {
+  *this = big_integer::divide(rhs);
+  return *this;
+}
+
+big_integer& big_integer::operator%=(const big_integer& rhs) {
+  big_integer::divide(rhs);
+  return *this;
+}
+
+template <typename Operation>
+void big_integer::bitwiseOp(const big_integer& other, Operation op) {
+  stats_scope stats(stats_op::bitwise, std::max(data_.size(), other.data_.size()));
+  // operands are processed as infinite two's complement: -m is ~(m - 1), so a negative operand only
+  // needs a borrow until its first non-zero limb and a negative result only a carry for ~r + 1
+  data_type mask_a = (sign < 0 && !isZero()) ? ~data_type(0) : 0;
+  data_type mask_b = (other.sign < 0 && !other.isZero()) ? ~data_type(0) : 0;
+  data_type mask_r = op(mask_a, mask_b);
+  size_t size_a = data_.size();
+  size_t size_b = other.data_.size();
+  size_t n = std::max(size_a, size_b) + (mask_r != 0);
+  data_.resize(n);
+  data_type* r = data_.data();
+  const data_type* b = other.data_.data();
+
+  data_type borrow_a = mask_a & 1;
+  data_type borrow_b = mask_b & 1;
+  data_type carry_r = mask_r & 1;
+  size_t i = 0;
+  for (; i < n && (borrow_a | borrow_b | carry_r) != 0; ++i) {
+    data_type limb_a = i < size_a ? r[i] : 0;
+    data_type limb_b = i < size_b ? b[i] : 0;
+    data_type res = op((limb_a - borrow_a) ^ mask_a, (limb_b - borrow_b) ^ mask_b);
+    res = (res ^ mask_r) + carry_r;
+    borrow_a &= (limb_a == 0);
+    borrow_b &= (limb_b == 0);
+    carry_r &= (res == 0);
+    r[i] = res;
+  }
+  size_t common = std::max(i, std::min(n, size_b));
+  bitwiseKernel(r, b, i, common, mask_a, mask_b, mask_r, op);
+  bitwiseKernel(r, nullptr, common, n, mask_a, mask_b, mask_r, op);
+
+  sign = (mask_r != 0 ? -1 : 1);
+  deleteLeadingZeroes();
+}
+
+big_integer& big_integer::operator&=(const big_integer& rhs) {
+  bitwiseOp(rhs, std::bit_and<>());
+  return *this;
+}
+
+big_integer& big_integer::operator|=(const big_integer& rhs) {
+  bitwiseOp(rhs, std::bit_or<>());
+  return *this;
+}
+
+big_integer& big_integer::operator^=(const big_integer& rhs) {
+  bitwiseOp(rhs, std::bit_xor<>());
+  return *this;
+}
+
+big_integer& big_integer::operator<<=(int rhs) {
+  stats_scope stats(stats_op::shift, data_.size());
+  if (isZero()) {
+    return *this;
+  }
+  size_t shiftAbs = rhs / BITS_COUNT;
+  unsigned shift = rhs % BITS_COUNT;
+  size_t n = data_.size();
+  data_.resize(n + shiftAbs + (shift != 0));
+  if (shift == 0) {
+    std::copy_backward(data_.begin(), data_.begin() + n, data_.begin() + n + shiftAbs);
+  } else {
+    data_[n + shiftAbs] = shiftLeft(data_.data() + shiftAbs, data_.data(), n, shift);
+  }
+  std::fill(data_.begin(), data_.begin() + shiftAbs, 0);
+  deleteLeadingZeroes();
+  return *this;
+}
+
+big_integer& big_integer::operator>>=(int rhs) {
+  stats_scope stats(stats_op::shift, data_.size());
+  size_t shiftAbs = rhs / BITS_COUNT;
+  unsigned shift = rhs % BITS_COUNT;
+  size_t n = data_.size();
+  if (shiftAbs >= n) {
+    *this = (sign < 0 && !isZero()) ? big_integer(-1) : big_integer();
+    return *this;
+  }
+  // shifting a negative number rounds towards minus infinity
+  bool round_up = sign < 0 && (std::any_of(data_.begin(), data_.begin() + shiftAbs, [](data_type x) { return x != 0; }) ||
+                               (shift != 0 && (data_[shiftAbs] << (BITS_COUNT - shift)) != 0));
+  if (shift == 0) {
+    std::copy(data_.begin() + shiftAbs, data_.end(), data_.begin());
+  } else {
+    shiftRight(data_.data(), data_.data() + shiftAbs, n - shiftAbs, shift);
+  }
+  data_.resize(n - shiftAbs);
+  if (round_up && addCarry(data_.data(), data_.size(), 1) != 0) {
+    data_.push_back(1);
+  }
+  deleteLeadingZeroes();
+  return *this;
+}
+
+big_integer big_integer::operator+() const noexcept {
+  return *this;
+}
+
+big_integer big_integer::operator-() const noexcept {
+  big_integer tmp = *this;
+  tmp.sign = -sign;
+  return tmp;
+}
+
+big_integer big_integer::operator~() const {
+  big_integer copy = *this;
+  copy.sign = -sign;
+  copy -= 1;
+  return copy;
+}
+
+big_integer& big_integer::operator++() {
+  *this += 1;
+  return *this;
+}
+
+big_integer big_integer::operator++(int) {
+  big_integer tmp = *this;
+  ++*this;
+  return tmp;
+}
+
+big_integer& big_integer::operator--() {
+  *this -= 1;
+  return *this;
+}
+
+big_integer big_integer::operator--(int) {
+  big_integer tmp = *this;
+  --*this;
+  return tmp;
+}
+
+big_integer operator+(const big_integer& a, const big_integer& b) {
+  big_integer out = a;
+  out += b;
+  return out;
+}
+
+big_integer operator+(big_integer&& a, const big_integer& b) {
+  a += b;
+  return std::move(a);
+}
+
+big_integer operator+(const big_integer& a, big_integer&& b) {
+  b += a;
+  return std::move(b);
+}
+
+big_integer operator+(big_integer&& a, big_integer&& b) {
+  a += b;
+  return std::move(a);
+}
+
+big_integer operator-(const big_integer& a, const big_integer& b) {
+  big_integer out = a;
+  out -= b;
+  return out;
+}
+
+big_integer operator-(big_integer&& a, const big_integer& b) {
+  a -= b;
+  return std::move(a);
 }
 
 big_integer operator*(const big_integer& a, const big_integer& b) {
@@ -438,48 +1481,128 @@ big_integer operator*(const big_integer& a, const big_integer& b) {
   return out;
 }
 
+big_integer operator*(big_integer&& a, const big_integer& b) {
+  a *= b;
+  return std::move(a);
+}
+
+big_integer operator*(const big_integer& a, big_integer&& b) {
+  b *= a;
+  return std::move(b);
+}
+
+big_integer operator*(big_integer&& a, big_integer&& b) {
+  a *= b;
+  return std::move(a);
+}
+
 big_integer operator/(const big_integer& a, const big_integer& b) {
   big_integer out = a;
   out /= b;
   return out;
 }
 
+big_integer operator/(big_integer&& a, const big_integer& b) {
+  a /= b;
+  return std::move(a);
+}
+
 big_integer operator%(const big_integer& a, const big_integer& b) {
   big_integer out = a;
   out %= b;
   return out;
 }
 
+big_integer operator%(big_integer&& a, const big_integer& b) {
+  a %= b;
+  return std::move(a);
+}
+
 big_integer operator&(const big_integer& a, const big_integer& b) {
   big_integer out = a;
   out &= b;
   return out;
 }
 
+big_integer operator&(big_integer&& a, const big_integer& b) {
+  a &= b;
+  return std::move(a);
+}
+
+big_integer operator&(const big_integer& a, big_integer&& b) {
+  b &= a;
+  return std::move(b);
+}
+
+big_integer operator&(big_integer&& a, big_integer&& b) {
+  a &= b;
+  return std::move(a);
+}
+
 big_integer operator|(const big_integer& a, const big_integer& b) {
   big_integer out = a;
   out |= b;
   return out;
 }
 
+big_integer operator|(big_integer&& a, const big_integer& b) {
+  a |= b;
+  return std::move(a);
+}
+
+big_integer operator|(const big_integer& a, big_integer&& b) {
+  b |= a;
+  return std::move(b);
+}
+
+big_integer operator|(big_integer&& a, big_integer&& b) {
+  a |= b;
+  return std::move(a);
+}
+
 big_integer operator^(const big_integer& a, const big_integer& b) {
   big_integer out = a;
   out ^= b;
   return out;
 }
 
+big_integer operator^(big_integer&& a, const big_integer& b) {
+  a ^= b;
+  return std::move(a);
+}
+
+big_integer operator^(const big_integer& a, big_integer&& b) {
+  b ^= a;
+  return std::move(b);
+}
+
+big_integer operator^(big_integer&& a, big_integer&& b) {
+  a ^= b;
+  return std::move(a);
+}
+
 big_integer operator<<(const big_integer& a, int b) {
   big_integer out = a;
   out <<= b;
   return out;
 }
 
+big_integer operator<<(big_integer&& a, int b) {
+  a <<= b;
+  return std::move(a);
+}
+
 big_integer operator>>(const big_integer& a, int b) {
   big_integer out = a;
   out >>= b;
   return out;
 }
 
+big_integer operator>>(big_integer&& a, int b) {
+  a >>= b;
+  return std::move(a);
+}
+
 bool operator==(const big_integer& a, const big_integer& b) noexcept {
   return (a.isZero() && b.isZero()) || ((a.sign == b.sign) && a.data_ == b.data_);
 }
@@ -495,14 +1618,7 @@ bool operator<(const big_integer& a, const big_integer& b) noexcept {
   if (a.sign != b.sign) {
     return a.sign < b.sign;
   }
-  if (a == b) {
-    return false;
-  }
-  if (a.data_.size() != b.data_.size()) {
-    return (a.sign > 0) ^ (a.data_.size() > b.data_.size());
-  }
-  return (a.sign == 1) ^
-         (!std::lexicographical_compare(a.data_.rbegin(), a.data_.rend(), b.data_.rbegin(), b.data_.rend()));
+  return a.sign * a.compareMagnitude(b) < 0;
 }
 
 bool operator>(const big_integer& a, const big_integer& b) noexcept {
@@ -517,41 +1633,1012 @@ bool operator>=(const big_integer& a, const big_integer& b) noexcept {
   return !(a < b);
 }
 
-uint64_t big_integer::divModByConst(uint64_t rhs) {
-  uint64_t carry = 0;
-  for (size_t i = data_.size(); i > 0; --i) {
-    uint64_t tmp = data_[i - 1] + carry * LIMIT;
-    data_[i - 1] = (tmp / rhs) % LIMIT;
-    carry = tmp % rhs;
+const big_integer& big_integer::powerOfTen(size_t k) {
+  static std::deque<big_integer> powers{big_integer(STR_NUMS)};
+  static std::mutex mutex;
+  // the cache outlives any arena
+  heap_scope scope;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (powers.size() <= k) {
+    // the square may go to the pool, whose jobs convert numbers and come back here, so it is computed without the
+    // lock; elements of a deque never move, and a square another thread appended in the meantime wins
+    size_t size = powers.size();
+    const big_integer& last = powers.back();
+    lock.unlock();
+    big_integer square = last * last;
+    lock.lock();
+    if (powers.size() == size) {
+      powers.push_back(std::move(square));
+    }
+  }
+  return powers[k];
+}
+
+void big_integer::writePadded(const big_integer& x, char* out, size_t k) {
+  size_t width = STR_NUMS_COUNT << k;
+  if (k == 0 || x.data_.size() <= CONVERSION_THRESHOLD) {
+    data_type buf[CONVERSION_THRESHOLD];
+    size_t n = x.data_.size();
+    std::copy(x.data_.begin(), x.data_.end(), buf);
+    for (char* end = out + width; end != out; end -= STR_NUMS_COUNT) {
+      while (n > 0 && buf[n - 1] == 0) {
+        --n;
+      }
+      if (n == 0) {
+        std::fill(out, end, '0');
+        break;
+      }
+      writeChunk(divRemSingle(buf, n, STR_NUMS), end, STR_NUMS_COUNT);
+    }
+    return;
   }
-  deleteLeadingZeroes();
-  return carry;
+  big_integer rem = x;
+  rem.sign = 1;
+  big_integer quotient = rem.divide(powerOfTen(k - 1));
+  parallelInvoke(
+      x.data_.size() >= parallel_threshold, [&] { writePadded(quotient, out, k - 1); },
+      [&] { writePadded(rem, out + width / 2, k - 1); });
 }
 
-std::string to_string(const big_integer& a) {
-  if (a.isZero()) {
-    return "0";
+char* big_integer::writeLeading(const big_integer& x, char* first, char* last) {
+  if (x.data_.size() <= CONVERSION_THRESHOLD) {
+    data_type buf[CONVERSION_THRESHOLD];
+    uint64_t chunks[CONVERSION_THRESHOLD + 1];
+    size_t n = x.data_.size();
+    size_t count = 0;
+    std::copy(x.data_.begin(), x.data_.end(), buf);
+    do {
+      chunks[count++] = divRemSingle(buf, n, STR_NUMS);
+      while (n > 0 && buf[n - 1] == 0) {
+        --n;
+      }
+    } while (n > 0);
+
+    size_t top_digits = 1;
+    for (uint64_t top = chunks[count - 1]; top >= 10; top /= 10) {
+      ++top_digits;
+    }
+    if (static_cast<size_t>(last - first) < top_digits + (count - 1) * STR_NUMS_COUNT) {
+      return nullptr;
+    }
+    first += top_digits;
+    writeChunk(chunks[--count], first, top_digits);
+    while (count > 0) {
+      first += STR_NUMS_COUNT;
+      writeChunk(chunks[--count], first, STR_NUMS_COUNT);
+    }
+    return first;
+  }
+  // split by the largest cached power that is at most half as long as x, so that the quotient is non-zero
+  size_t k = 0;
+  while (2 * (2 * powerOfTen(k).data_.size() - 1) <= x.data_.size() &&
+         2 * powerOfTen(k + 1).data_.size() <= x.data_.size()) {
+    ++k;
+  }
+  big_integer rem = x;
+  rem.sign = 1;
+  big_integer quotient = rem.divide(powerOfTen(k));
+  size_t width = STR_NUMS_COUNT << k;
+  if (parallelEnabled(x.data_.size() >= parallel_threshold)) {
+    // where the low digits go depends on the length of the high ones, so they are written aside and copied
+    std::string low(width, '0');
+    parallelInvoke(
+        true, [&] { first = writeLeading(quotient, first, last); }, [&] { writePadded(rem, low.data(), k); });
+    if (first == nullptr || static_cast<size_t>(last - first) < width) {
+      return nullptr;
+    }
+    return std::copy(low.begin(), low.end(), first);
   }
-  std::string res;
-  big_integer tmp = a;
-  tmp.sign = 1;
-  while (tmp > 0) {
-    uint64_t num = tmp.divModByConst(a.STR_NUMS);
-    std::string tmp_digits = std::to_string(num);
-    for (std::string::reverse_iterator it = tmp_digits.rbegin(); it < tmp_digits.rend(); ++it) {
-      res += *it;
+  first = writeLeading(quotient, first, last);
+  if (first == nullptr || static_cast<size_t>(last - first) < width) {
+    return nullptr;
+  }
+  writePadded(rem, first, k);
+  return first + width;
+}
+
+big_integer big_integer::parseDigits(const char* first, size_t len) {
+  big_integer res;
+  if (len <= CONVERSION_THRESHOLD * STR_NUMS_COUNT) {
+    res.data_.resize((len + STR_NUMS_COUNT - 1) / STR_NUMS_COUNT);
+    size_t n = 0;
+    size_t chunk = len % STR_NUMS_COUNT == 0 ? STR_NUMS_COUNT : len % STR_NUMS_COUNT;
+    for (const char* last = first + len; first != last; first += chunk, chunk = STR_NUMS_COUNT) {
+      uint64_t power = 1;
+      for (size_t i = 0; i < chunk; ++i) {
+        power *= 10;
+      }
+      data_type carry = mulAddSingle(res.data_.data(), n, power, parseChunk(first, first + chunk));
+      if (carry != 0) {
+        res.data_[n++] = carry;
+      }
     }
-    if (tmp > 0) {
-      res += std::string(a.STR_NUMS_COUNT - tmp_digits.size(), '0');
+    res.data_.resize(n);
+    return res;
+  }
+  size_t k = 0;
+  while ((STR_NUMS_COUNT << (k + 1)) < len) {
+    ++k;
+  }
+  size_t low_len = STR_NUMS_COUNT << k;
+  std::optional<big_integer> high, low;
+  parallelInvoke(
+      len >= parallel_threshold * STR_NUMS_COUNT, [&] { high.emplace(parseDigits(first, len - low_len)); },
+      [&] { low.emplace(parseDigits(first + len - low_len, low_len)); });
+  res = std::move(*high);
+  res *= powerOfTen(k);
+  res += *low;
+  return res;
+}
+
+std::to_chars_result to_chars(char* first, char* last, const big_integer& value) {
+  stats_scope stats(stats_op::to_string, value.data_.size());
+  if (value.sign < 0 && !value.isZero()) {
+    if (first == last) {
+      return {last, std::errc::value_too_large};
     }
+    *first++ = '-';
+  }
+  char* end = big_integer::writeLeading(value, first, last);
+  if (end == nullptr) {
+    return {last, std::errc::value_too_large};
+  }
+  return {end, std::errc()};
+}
+
+std::from_chars_result from_chars(const char* first, const char* last, big_integer& value) {
+  stats_scope stats(stats_op::from_string,
+                    (last - first + big_integer::STR_NUMS_COUNT - 1) / big_integer::STR_NUMS_COUNT);
+  const char* digits = first;
+  if (digits != last && *digits == '-') {
+    ++digits;
   }
-  if (a.sign == -1) {
-    res += "-";
+  const char* end = std::find_if_not(digits, last, [](char c) { return c >= '0' && c <= '9'; });
+  if (end == digits) {
+    return {first, std::errc::invalid_argument};
   }
-  std::reverse(res.begin(), res.end());
+  big_integer::parseDigits(digits, end - digits).swap(value);
+  value.sign = (digits != first && !value.isZero() ? -1 : 1);
+  return {end, std::errc()};
+}
+
+std::string to_string(const big_integer& a) {
+  // log10(2) < 1234 / 4096, one more char for the sign and one for rounding
+  std::string res(a.data_.size() * a.BITS_COUNT * 1234 / 4096 + 2, '\0');
+  res.resize(to_chars(res.data(), res.data() + res.size(), a).ptr - res.data());
   return res;
 }
 
 std::ostream& operator<<(std::ostream& out, const big_integer& a) {
   return out << to_string(a);
 }
+
+size_t export_words(const big_integer& value, size_t word_size) noexcept {
+  if (value.isZero()) {
+    return 0;
+  }
+  size_t bytes = (value.data_.size() - 1) * sizeof(limb) + (std::bit_width(value.data_.back()) + 7) / 8;
+  return (bytes + word_size - 1) / word_size;
+}
+
+size_t export_bytes(const big_integer& value, void* out, size_t word_size, std::endian word_order,
+                    std::endian byte_order) {
+  if (word_size == 0) {
+    throw std::invalid_argument("word size must be positive");
+  }
+  size_t words = export_words(value, word_size);
+  unsigned char* dest = static_cast<unsigned char*>(out);
+  if (word_size == sizeof(limb) && word_order == std::endian::little && byte_order == std::endian::little &&
+      std::endian::native == std::endian::little) {
+    if (words != 0) {
+      std::memcpy(dest, value.data_.data(), words * word_size);
+    }
+    return words;
+  }
+  size_t total = value.isZero() ? 0 : value.data_.size() * sizeof(limb);
+  for (size_t w = 0; w < words; ++w) {
+    unsigned char* word = dest + (word_order == std::endian::little ? w : words - 1 - w) * word_size;
+    for (size_t j = 0; j < word_size; ++j) {
+      size_t i = w * word_size + j;
+      limb byte = i < total ? value.data_[i / sizeof(limb)] >> (i % sizeof(limb) * 8) : 0;
+      word[byte_order == std::endian::little ? j : word_size - 1 - j] = static_cast<unsigned char>(byte);
+    }
+  }
+  return words;
+}
+
+big_integer import_bytes(const void* in, size_t count, size_t word_size, std::endian word_order,
+                         std::endian byte_order) {
+  if (word_size == 0) {
+    throw std::invalid_argument("word size must be positive");
+  }
+  const unsigned char* src = static_cast<const unsigned char*>(in);
+  big_integer res;
+  res.data_.resize((count * word_size + sizeof(limb) - 1) / sizeof(limb));
+  if (word_size == sizeof(limb) && word_order == std::endian::little && byte_order == std::endian::little &&
+      std::endian::native == std::endian::little) {
+    // in may be null when there is nothing to read, which memcpy doesn't allow even for zero bytes
+    if (count != 0) {
+      std::memcpy(res.data_.data(), src, count * word_size);
+    }
+  } else {
+    for (size_t w = 0; w < count; ++w) {
+      const unsigned char* word = src + (word_order == std::endian::little ? w : count - 1 - w) * word_size;
+      for (size_t j = 0; j < word_size; ++j) {
+        size_t i = w * word_size + j;
+        limb byte = word[byte_order == std::endian::little ? j : word_size - 1 - j];
+        res.data_[i / sizeof(limb)] |= byte << (i % sizeof(limb) * 8);
+      }
+    }
+  }
+  res.deleteLeadingZeroes();
+  return res;
+}
+
+namespace {
+constexpr char SERIALIZED_MAGIC[4] = {'B', 'I', 'G', 'I'};
+constexpr size_t SERIALIZED_HEADER = 16;
+
+void storeLittle(char* out, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    out[i] = static_cast<char>(value >> (8 * i));
+  }
+}
+
+uint64_t loadLittle(const char* in, size_t bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < bytes; ++i) {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+  }
+  return value;
+}
+} // namespace
+
+size_t serialized_size(const big_integer& value) noexcept {
+  return SERIALIZED_HEADER + export_words(value, sizeof(limb)) * sizeof(limb);
+}
+
+char* serialize(const big_integer& value, char* out) {
+  size_t count = export_words(value, sizeof(limb));
+  std::memcpy(out, SERIALIZED_MAGIC, sizeof(SERIALIZED_MAGIC));
+  storeLittle(out + 4, value.sign < 0 && count != 0 ? 1 : 0, 4);
+  storeLittle(out + 8, count, 8);
+  export_bytes(value, out + SERIALIZED_HEADER, sizeof(limb), std::endian::little, std::endian::little);
+  return out + SERIALIZED_HEADER + count * sizeof(limb);
+}
+
+big_integer_view::big_integer_view(const char* data, size_t size) : data_(data), size_(0) {
+  wrap(size);
+}
+
+big_integer_view::big_integer_view(const big_integer_view& other) : data_(other.data_), size_(0) {
+  wrap(other.size_);
+}
+
+big_integer_view& big_integer_view::operator=(const big_integer_view& other) {
+  if (this != &other) {
+    data_ = other.data_;
+    wrap(other.size_);
+  }
+  return *this;
+}
+
+void big_integer_view::wrap(size_t available) {
+  if (available < SERIALIZED_HEADER || std::memcmp(data_, SERIALIZED_MAGIC, sizeof(SERIALIZED_MAGIC)) != 0) {
+    throw std::invalid_argument("not a serialized big_integer");
+  }
+  uint64_t flags = loadLittle(data_ + 4, 4);
+  uint64_t count = loadLittle(data_ + 8, 8);
+  if (flags > 1 || count > (available - SERIALIZED_HEADER) / sizeof(limb)) {
+    throw std::invalid_argument("corrupted serialized big_integer");
+  }
+  const char* limbs = data_ + SERIALIZED_HEADER;
+  if (std::endian::native == std::endian::little && count != 0 &&
+      reinterpret_cast<uintptr_t>(limbs) % alignof(limb) == 0) {
+    const limb* first = reinterpret_cast<const limb*>(limbs);
+    size_t n = count;
+    while (n > 1 && first[n - 1] == 0) {
+      --n;
+    }
+    value_.data_.borrow(first, n);
+  } else {
+    value_ = import_bytes(limbs, count, sizeof(limb), std::endian::little, std::endian::little);
+  }
+  value_.sign = (flags & 1) != 0 ? -1 : 1;
+  size_ = SERIALIZED_HEADER + count * sizeof(limb);
+}
+
+const big_integer& big_integer_view::value() const noexcept {
+  return value_;
+}
+
+big_integer_view::operator const big_integer&() const noexcept {
+  return value_;
+}
+
+size_t big_integer_view::size() const noexcept {
+  return size_;
+}
+
+montgomery_context::montgomery_context(const big_integer& mod) : mod_(mod) {
+  mod_.deleteLeadingZeroes();
+  if (mod_.sign < 0 || mod_.isZero() || mod_.data_[0] % 2 == 0) {
+    throw std::invalid_argument("montgomery modulus must be odd and positive");
+  }
+  size_t n = mod_.data_.size();
+  inv_ = montgomeryInverse(mod_.data_[0]);
+  big_integer r2 = big_integer(1) << static_cast<int>(2 * n * big_integer::BITS_COUNT);
+  r2 %= mod_;
+  r2_.assign(r2.data_.begin(), r2.data_.end());
+  r2_.resize(n);
+}
+
+const big_integer& montgomery_context::modulus() const noexcept {
+  return mod_;
+}
+
+big_integer montgomery_context::pow(const big_integer& base, const big_integer& exp) const {
+  stats_scope stats(stats_op::pow_mod, mod_.data_.size());
+  if (exp.sign < 0 && !exp.isZero()) {
+    throw std::invalid_argument("exponent must be non-negative");
+  }
+  size_t n = mod_.data_.size();
+  if (n == 1 && mod_.data_[0] == 1) {
+    return big_integer();
+  }
+  if (exp.isZero()) {
+    return big_integer(1);
+  }
+  big_integer b = base % mod_;
+  if (b.sign < 0 && !b.isZero()) {
+    b += mod_;
+  }
+  b.data_.resize(n);
+
+  const size_t bits = exp.data_.size() * big_integer::BITS_COUNT - std::countl_zero(exp.data_.back());
+  const size_t window = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+  const size_t odd_powers = size_t(1) << (window - 1);
+
+  // everything the ladder touches: b, b^3, ..., b^(2^window - 1), the accumulator, b^2 and the product
+  std::vector<data_type> buf((odd_powers + 4) * n);
+  data_type* table = buf.data();
+  data_type* acc = table + odd_powers * n;
+  data_type* square = acc + n;
+  data_type* t = square + n;
+  const data_type* m = mod_.data_.data();
+  auto mul = [&](data_type* r, const data_type* x, const data_type* y) {
+    if (x == y) {
+      sqrBasecase(t, x, n);
+    } else {
+      mulBasecase(t, x, n, y, n);
+    }
+    montgomeryReduce(r, t, m, n, inv_);
+  };
+  auto bit = [&exp](size_t i) -> size_t {
+    return (exp.data_[i / big_integer::BITS_COUNT] >> (i % big_integer::BITS_COUNT)) & 1;
+  };
+
+  mul(table, b.data_.data(), r2_.data());
+  mul(square, table, table);
+  for (size_t i = 1; i < odd_powers; ++i) {
+    mul(table + i * n, table + (i - 1) * n, square);
+  }
+
+  for (size_t i = bits; i > 0;) {
+    if (bit(i - 1) == 0) {
+      mul(acc, acc, acc);
+      --i;
+      continue;
+    }
+    // the longest window [low, i) that ends with a set bit
+    size_t low = i > window ? i - window : 0;
+    while (bit(low) == 0) {
+      ++low;
+    }
+    size_t value = 0;
+    for (size_t j = i; j-- > low;) {
+      value = value * 2 + bit(j);
+    }
+    if (i == bits) {
+      std::copy_n(table + value / 2 * n, n, acc);
+    } else {
+      for (size_t j = low; j < i; ++j) {
+        mul(acc, acc, acc);
+      }
+      mul(acc, acc, table + value / 2 * n);
+    }
+    i = low;
+  }
+
+  std::copy_n(acc, n, t);
+  std::fill(t + n, t + 2 * n, 0);
+  montgomeryReduce(acc, t, m, n, inv_);
+  return big_integer::fromLimbs(acc, n);
+}
+
+big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod) {
+  stats_scope stats(stats_op::pow_mod, mod.data_.size());
+  big_integer m = mod;
+  m.sign = 1;
+  m.deleteLeadingZeroes();
+  if (m.isZero()) {
+    throw std::runtime_error("dividing by zero");
+  }
+  if (m.data_[0] % 2 != 0) {
+    return montgomery_context(m).pow(base, exp);
+  }
+  if (exp.sign < 0 && !exp.isZero()) {
+    throw std::invalid_argument("exponent must be non-negative");
+  }
+  // Montgomery reduction needs an odd modulus, even ones are reduced by division
+  big_integer b = base % m;
+  if (b.sign < 0 && !b.isZero()) {
+    b += m;
+  }
+  big_integer res = big_integer(1) % m;
+  for (size_t i = exp.data_.size() * big_integer::BITS_COUNT; i-- > 0;) {
+    res *= res;
+    res %= m;
+    if ((exp.data_[i / big_integer::BITS_COUNT] >> (i % big_integer::BITS_COUNT)) & 1) {
+      res *= b;
+      res %= m;
+    }
+  }
+  return res;
+}
+
+void addmul(big_integer& acc, const big_integer& a, const big_integer& b) {
+  acc.addProduct(a, b, a.sign * b.sign);
+}
+
+void submul(big_integer& acc, const big_integer& a, const big_integer& b) {
+  acc.addProduct(a, b, -a.sign * b.sign);
+}
+
+big_integer mul_mod(const big_integer& a, const big_integer& b, const big_integer& mod) {
+  big_integer res;
+  if (!a.isZero() && !b.isZero()) {
+    res.data_.resize(a.data_.size() + b.data_.size());
+    big_integer::mulMagnitude(res.data_.data(), a.data_.data(), a.data_.size(), b.data_.data(), b.data_.size());
+    res.deleteLeadingZeroes();
+    res.sign = a.sign * b.sign;
+  }
+  res.divide(mod);
+  if (res.sign < 0 && !res.isZero()) {
+    res.sign *= mod.sign;
+    res += mod;
+    res.sign *= mod.sign;
+  }
+  return res;
+}
+
+big_integer_arena::big_integer_arena(size_t block_size)
+    : block_size_(block_size), blocks_(nullptr), current_(nullptr), end_(nullptr), free_(), previous_(current_arena) {
+  current_arena = this;
+}
+
+big_integer_arena::~big_integer_arena() {
+  current_arena = previous_;
+  while (blocks_ != nullptr) {
+    block* next = blocks_->next;
+    operator delete(blocks_);
+    blocks_ = next;
+  }
+}
+
+void* big_integer_arena::allocate(size_t bytes) {
+  size_t size_class = arenaSizeClass(bytes);
+  if (free_[size_class] != nullptr) {
+    free_node* res = free_[size_class];
+    free_[size_class] = res->next;
+    return res;
+  }
+  bytes = arenaClassSize(size_class);
+  if (static_cast<size_t>(end_ - current_) < bytes) {
+    size_t size = sizeof(block) + std::max(block_size_, bytes);
+    auto* new_block = static_cast<block*>(operator new(size));
+    new_block->next = blocks_;
+    blocks_ = new_block;
+    current_ = reinterpret_cast<char*>(new_block + 1);
+    end_ = reinterpret_cast<char*>(new_block) + size;
+  }
+  void* res = current_;
+  current_ += bytes;
+  return res;
+}
+
+void big_integer_arena::deallocate(void* p, size_t bytes) noexcept {
+  size_t size_class = arenaSizeClass(bytes);
+  free_[size_class] = new (p) free_node{free_[size_class]};
+}
+
+struct big_integer::hgcd_matrix {
+  big_integer u00 = 1;
+  big_integer u01 = 0;
+  big_integer u10 = 0;
+  big_integer u11 = 1;
+
+  // *this = *this * other
+  void multiply(const hgcd_matrix& other) {
+    big_integer t00 = u00 * other.u00;
+    addmul(t00, u01, other.u10);
+    big_integer t01 = u00 * other.u01;
+    addmul(t01, u01, other.u11);
+    big_integer t10 = u10 * other.u00;
+    addmul(t10, u11, other.u10);
+    big_integer t11 = u10 * other.u01;
+    addmul(t11, u11, other.u11);
+    u00 = std::move(t00);
+    u01 = std::move(t01);
+    u10 = std::move(t10);
+    u11 = std::move(t11);
+  }
+
+  // *this = *this * (m00, m01; m10, m11) for the small non-negative matrix of a Lehmer step
+  void multiply(limb m00, limb m01, limb m10, limb m11, std::vector<limb>& scratch) {
+    multiplyRow(u00, u01, m00, m01, m10, m11, scratch);
+    multiplyRow(u10, u11, m00, m01, m10, m11, scratch);
+  }
+
+  // (a, b) = this^-1 (a, b), the inverse is (u11, -u01; -u10, u00)
+  void applyInverse(big_integer& a, big_integer& b) const {
+    big_integer t = u11 * a;
+    submul(t, u01, b);
+    b = u00 * b;
+    submul(b, u10, a);
+    a = std::move(t);
+  }
+
+private:
+  // (x, y) = (x * m00 + y * m10, x * m01 + y * m11), all entries of the Euclid matrices are non-negative
+  static void multiplyRow(big_integer& x, big_integer& y, limb m00, limb m01, limb m10, limb m11,
+                          std::vector<limb>& scratch) {
+    size_t n = std::max(x.data_.size(), y.data_.size());
+    x.data_.resize(n + 2);
+    y.data_.resize(n + 2);
+    scratch.assign(x.data_.begin(), x.data_.begin() + n);
+    x.data_[n] = mulAddSingle(x.data_.data(), n, m00, 0);
+    addCarry(x.data_.data() + n, 2, addMul(x.data_.data(), y.data_.data(), n, m10));
+    y.data_[n] = mulAddSingle(y.data_.data(), n, m11, 0);
+    addCarry(y.data_.data() + n, 2, addMul(y.data_.data(), scratch.data(), n, m01));
+    x.deleteLeadingZeroes();
+    y.deleteLeadingZeroes();
+  }
+};
+
+size_t big_integer::bitLength(const big_integer& x) noexcept {
+  return x.isZero() ? 0 : (x.data_.size() - 1) * BITS_COUNT + std::bit_width(x.data_.back());
+}
+
+bool big_integer::lehmerStep(big_integer& a, big_integer& b, size_t s, hgcd_matrix* m,
+                             std::vector<data_type>& scratch) {
+  // The top is reduced while it stays above 2^32, which is more than half of its bits, so by Möller's lemma
+  // the steps are also valid for a and b and leave them above 2^(shift + 31) >= 2^s. The matrix
+  // entries stay below 2^30. Single limbs are known exactly, and plain Euclid runs on them to the end.
+  bool exact = s == 0 && a.data_.size() <= 1 && b.data_.size() <= 1;
+  uint64_t limit = exact ? 0 : uint64_t(1) << 32;
+  size_t shift = exact ? 0 : std::max({bitLength(a), bitLength(b), s + 31, size_t(62)}) - 62;
+  auto top = [shift](const big_integer& x) -> uint64_t {
+    size_t i = shift / BITS_COUNT;
+    size_t offset = shift % BITS_COUNT;
+    if (i >= x.data_.size()) {
+      return 0;
+    }
+    uint64_t word = x.data_[i] >> offset;
+    if (offset != 0 && i + 1 < x.data_.size()) {
+      word |= x.data_[i + 1] << (BITS_COUNT - offset);
+    }
+    return word;
+  };
+  uint64_t ah = top(a);
+  uint64_t bh = top(b);
+  uint64_t m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+  while (true) {
+    if (ah >= bh) {
+      if (bh == 0 || bh < limit || ah - bh < limit) {
+        break;
+      }
+      uint64_t q = (ah - limit) / bh;
+      ah -= q * bh;
+      m01 += q * m00;
+      m11 += q * m10;
+    } else {
+      if (ah == 0 || ah < limit || bh - ah < limit) {
+        break;
+      }
+      uint64_t q = (bh - limit) / ah;
+      bh -= q * ah;
+      m00 += q * m01;
+      m10 += q * m11;
+    }
+  }
+  if (m01 == 0 && m10 == 0) {
+    return false;
+  }
+
+  // (a, b) = (m11 * a - m01 * b, m00 * b - m10 * a), both are non-negative and the top limbs cancel out
+  size_t n = std::max(a.data_.size(), b.data_.size());
+  a.data_.resize(n);
+  b.data_.resize(n);
+  scratch.assign(a.data_.begin(), a.data_.end());
+  mulAddSingle(a.data_.data(), n, m11, 0);
+  subMul(a.data_.data(), b.data_.data(), n, m01);
+  mulAddSingle(b.data_.data(), n, m00, 0);
+  subMul(b.data_.data(), scratch.data(), n, m10);
+  a.deleteLeadingZeroes();
+  b.deleteLeadingZeroes();
+  if (m != nullptr) {
+    m->multiply(m00, m01, m10, m11, scratch);
+  }
+  return true;
+}
+
+bool big_integer::divisionStep(big_integer& a, big_integer& b, size_t s, hgcd_matrix* m) {
+  bool reduce_a = a.compareMagnitude(b) >= 0;
+  big_integer& x = reduce_a ? a : b;
+  const big_integer& y = reduce_a ? b : a;
+  if (y.isZero() || bitLength(y) <= s) {
+    return false;
+  }
+  if (s != 0 && bitLength(x - y) <= s) {
+    return false;
+  }
+  big_integer q = x.divide(y);
+  if (s != 0 && bitLength(x) <= s) {
+    // the remainder went too low, take one y less
+    q -= 1;
+    x += y;
+  }
+  if (m != nullptr) {
+    if (reduce_a) {
+      addmul(m->u01, q, m->u00);
+      addmul(m->u11, q, m->u10);
+    } else {
+      addmul(m->u00, q, m->u01);
+      addmul(m->u10, q, m->u11);
+    }
+  }
+  return true;
+}
+
+bool big_integer::hgcd(big_integer& a, big_integer& b, hgcd_matrix& m) {
+  size_t n = std::max(bitLength(a), bitLength(b));
+  size_t s = n / 2 + 1;
+  std::vector<data_type> scratch;
+  auto step = [&] { return lehmerStep(a, b, s, &m, scratch) || divisionStep(a, b, s, &m); };
+  bool reduced = false;
+  if (n >= hgcd_threshold * BITS_COUNT) {
+    // the top half reduced to its half leaves a and b at about 3n / 4 bits
+    size_t p = n / 2;
+    big_integer a1 = a >> static_cast<int>(p);
+    big_integer b1 = b >> static_cast<int>(p);
+    if (hgcd(a1, b1, m)) {
+      m.applyInverse(a, b);
+      reduced = true;
+    }
+    while (std::max(bitLength(a), bitLength(b)) > 3 * n / 4 + 1) {
+      if (!step()) {
+        return reduced;
+      }
+      reduced = true;
+    }
+    // and the top 2(n' - s) bits of those reduced to their half leave them at about s bits
+    size_t n2 = std::max(bitLength(a), bitLength(b));
+    if (n2 > s + 2 * BITS_COUNT) {
+      p = 2 * s - n2 + 1;
+      a1 = a >> static_cast<int>(p);
+      b1 = b >> static_cast<int>(p);
+      hgcd_matrix m1;
+      if (hgcd(a1, b1, m1)) {
+        m1.applyInverse(a, b);
+        m.multiply(m1);
+        reduced = true;
+      }
+    }
+  }
+  while (step()) {
+    reduced = true;
+  }
+  return reduced;
+}
+
+void big_integer::gcdReduce(big_integer& a, big_integer& b, hgcd_matrix* m) {
+  std::vector<data_type> scratch;
+  while (!a.isZero() && !b.isZero()) {
+    if (m == nullptr && a.data_.size() == 1 && b.data_.size() == 1) {
+      a = std::gcd(a.data_[0], b.data_[0]);
+      b = 0;
+      return;
+    }
+    size_t n = std::max(bitLength(a), bitLength(b));
+    if (n >= hgcd_threshold * BITS_COUNT) {
+      // Cofactors are cheapest to build from a few large matrices, the plain gcd only needs to reduce a and b
+      // and applies the half-GCD of their top third.
+      hgcd_matrix h;
+      if (m != nullptr) {
+        if (hgcd(a, b, h)) {
+          m->multiply(h);
+          continue;
+        }
+      } else {
+        size_t p = 2 * n / 3;
+        big_integer a1 = a >> static_cast<int>(p);
+        big_integer b1 = b >> static_cast<int>(p);
+        if (hgcd(a1, b1, h)) {
+          h.applyInverse(a, b);
+          continue;
+        }
+      }
+    }
+    if (!lehmerStep(a, b, 0, m, scratch)) {
+      divisionStep(a, b, 0, m);
+    }
+  }
+}
+
+big_integer gcd(const big_integer& a, const big_integer& b) {
+  stats_scope stats(stats_op::gcd, std::min(a.data_.size(), b.data_.size()));
+  big_integer x = a;
+  big_integer y = b;
+  x.sign = 1;
+  y.sign = 1;
+  big_integer::gcdReduce(x, y, nullptr);
+  return x.isZero() ? y : x;
+}
+
+big_integer xgcd(const big_integer& a, const big_integer& b, big_integer& x, big_integer& y) {
+  stats_scope stats(stats_op::gcd, std::min(a.data_.size(), b.data_.size()));
+  bool negative_a = a.sign < 0 && !a.isZero();
+  bool negative_b = b.sign < 0 && !b.isZero();
+  big_integer u = a;
+  big_integer v = b;
+  u.sign = 1;
+  v.sign = 1;
+  big_integer::hgcd_matrix m;
+  big_integer::gcdReduce(u, v, &m);
+  // (u, v) = m^-1 (|a|, |b|) and one of them is zero now
+  big_integer g;
+  if (v.isZero()) {
+    g = std::move(u);
+    x = std::move(m.u11);
+    y = -m.u01;
+  } else {
+    g = std::move(v);
+    x = -m.u10;
+    y = std::move(m.u00);
+  }
+  if (negative_a) {
+    x = -x;
+  }
+  if (negative_b) {
+    y = -y;
+  }
+  return g;
+}
+
+big_integer mod_inverse(const big_integer& a, const big_integer& mod) {
+  big_integer m = mod;
+  m.sign = 1;
+  if (m.isZero()) {
+    throw std::runtime_error("dividing by zero");
+  }
+  big_integer r = a % m;
+  if (r.sign < 0 && !r.isZero()) {
+    r += m;
+  }
+  big_integer x, y;
+  if (xgcd(r, m, x, y) != 1) {
+    throw std::invalid_argument("not invertible");
+  }
+  x %= m;
+  if (x.sign < 0 && !x.isZero()) {
+    x += m;
+  }
+  return x;
+}
+
+big_integer pow(const big_integer& base, uint64_t exp) {
+  if (exp == 0) {
+    return 1;
+  }
+  if (base.isZero()) {
+    return 0;
+  }
+  // the power of two in base turns into a single shift, the rest runs left-to-right squarings
+  size_t zeroes = 0;
+  while (base.data_[zeroes / big_integer::BITS_COUNT] == 0) {
+    zeroes += big_integer::BITS_COUNT;
+  }
+  zeroes += std::countr_zero(base.data_[zeroes / big_integer::BITS_COUNT]);
+  if (zeroes != 0 && exp > std::numeric_limits<int>::max() / zeroes) {
+    throw std::length_error("big_integer is too long");
+  }
+  big_integer odd = base >> static_cast<int>(zeroes);
+  odd.sign = 1;
+  big_integer res = odd;
+  for (int i = std::bit_width(exp) - 2; i >= 0; --i) {
+    res *= res;
+    if ((exp >> i) & 1) {
+      res *= odd;
+    }
+  }
+  res <<= static_cast<int>(zeroes * exp);
+  if (base.sign < 0 && (exp & 1) != 0) {
+    res.sign = -1;
+  }
+  return res;
+}
+
+big_integer big_integer::sqrtRem(const big_integer& n, big_integer& rem) {
+  size_t bits = bitLength(n);
+  if (bits <= BITS_COUNT) {
+    uint64_t value = n.isZero() ? 0 : n.data_[0];
+    // the rounding of the double is fixed up in exact arithmetic
+    uint64_t root = static_cast<uint64_t>(std::sqrt(static_cast<double>(value)));
+    while (static_cast<uint128_t>(root) * root > value) {
+      --root;
+    }
+    while (static_cast<uint128_t>(root + 1) * (root + 1) <= value) {
+      ++root;
+    }
+    rem = value - root * root;
+    return root;
+  }
+  // Zimmermann's Karatsuba square root: with n = (a3 a2 a1 a0) in digits of l bits, where the top half
+  // a3 a2 keeps the top two bits of n, (s, r) = sqrtrem(a3 a2) and (q, u) = divrem(r a1, 2s) give
+  // s q as the root up to a single correction, so that the only division is of half the size.
+  size_t l = (bits + 1) / 4;
+  auto digit = [&n, l](size_t i) {
+    big_integer x = n >> static_cast<int>(i * l);
+    size_t size = (l + BITS_COUNT - 1) / BITS_COUNT;
+    if (x.data_.size() > size) {
+      x.data_.resize(size);
+    }
+    if (l % BITS_COUNT != 0 && x.data_.size() == size) {
+      x.data_.back() &= (data_type(1) << (l % BITS_COUNT)) - 1;
+    }
+    x.deleteLeadingZeroes();
+    return x;
+  };
+  big_integer r;
+  big_integer root = sqrtRem(n >> static_cast<int>(2 * l), r);
+  r <<= static_cast<int>(l);
+  r += digit(1);
+  big_integer q = r.divide(root << 1);
+  root <<= static_cast<int>(l);
+  root += q;
+  r <<= static_cast<int>(l);
+  r += digit(0);
+  submul(r, q, q);
+  if (r.sign < 0 && !r.isZero()) {
+    r += root;
+    root -= 1;
+    r += root;
+  }
+  rem = std::move(r);
+  return root;
+}
+
+big_integer big_integer::rootMagnitude(const big_integer& n, uint64_t k) {
+  size_t bits = bitLength(n);
+  if (bits <= k) {
+    return n.isZero() ? 0 : 1;
+  }
+  size_t root_bits = (bits + k - 1) / k;
+  size_t guard = std::bit_width(k) + 2;
+  if (root_bits >= 2 * guard + 2) {
+    // The root of the top bits is correct to half of the root's bits less the guard ones, one more keeps it
+    // above the root. A Newton step doubles that and leaves x at most a couple of units above the root.
+    size_t h = root_bits / 2 - guard;
+    big_integer x = rootMagnitude(n >> static_cast<int>(k * h), k);
+    x += 1;
+    x <<= static_cast<int>(h);
+    big_integer q = n / pow(x, k - 1);
+    addmul(q, x, k - 1);
+    x = q / k;
+    while (pow(x, k) > n) {
+      x -= 1;
+    }
+    return x;
+  }
+  // Newton's iteration x = ((k - 1) x + n / x^(k - 1)) / k decreases monotonically to the root from above,
+  // the root is the first x with x^k <= n, that is n / x^(k - 1) >= x
+  big_integer x = big_integer(1) << static_cast<int>(root_bits);
+  while (true) {
+    big_integer q = n / pow(x, k - 1);
+    if (q >= x) {
+      return x;
+    }
+    addmul(q, x, k - 1);
+    x = q / k;
+  }
+}
+
+big_integer isqrt(const big_integer& n) {
+  return iroot(n, 2);
+}
+
+big_integer iroot(const big_integer& n, uint64_t k) {
+  if (k == 0) {
+    throw std::invalid_argument("root degree must be positive");
+  }
+  if (n.sign < 0 && !n.isZero()) {
+    if (k % 2 == 0) {
+      throw std::invalid_argument("even root of a negative number");
+    }
+    big_integer magnitude = n;
+    magnitude.sign = 1;
+    return -big_integer::rootMagnitude(magnitude, k);
+  }
+  if (k == 1) {
+    return n;
+  }
+  if (k == 2) {
+    big_integer rem;
+    return big_integer::sqrtRem(n, rem);
+  }
+  return big_integer::rootMagnitude(n, k);
+}
+
+big_integer_stats big_integer_stats::snapshot() {
+  big_integer_stats res;
+#ifdef BIGINT_STATS
+  auto load = [](counters& out, const stats_counters& in) {
+    out.calls = in.calls.load(std::memory_order_relaxed);
+    out.cycles = in.cycles.load(std::memory_order_relaxed);
+    out.allocations = in.allocations.load(std::memory_order_relaxed);
+    out.allocated_bytes = in.allocated_bytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < HISTOGRAM_SIZE; ++i) {
+      out.size_histogram[i] = in.size_histogram[i].load(std::memory_order_relaxed);
+    }
+  };
+  for (size_t i = 0; i < OPERATION_COUNT; ++i) {
+    load(res.operations[i], global_stats[i]);
+  }
+  counters other = {};
+  load(other, other_stats);
+  res.other_allocations = other.allocations;
+  res.other_allocated_bytes = other.allocated_bytes;
+#endif
+  return res;
+}
+
+void big_integer_stats::reset() {
+#ifdef BIGINT_STATS
+  auto clear = [](stats_counters& counters) {
+    counters.calls.store(0, std::memory_order_relaxed);
+    counters.cycles.store(0, std::memory_order_relaxed);
+    counters.allocations.store(0, std::memory_order_relaxed);
+    counters.allocated_bytes.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint64_t>& bucket : counters.size_histogram) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  };
+  for (stats_counters& counters : global_stats) {
+    clear(counters);
+  }
+  clear(other_stats);
+#endif
+}
+
+const char* big_integer_stats::name(operation op) noexcept {
+  static const char* const NAMES[OPERATION_COUNT] = {"add",     "subtract",  "multiply",    "divide",  "shift",
+                                                     "bitwise", "to_string", "from_string", "pow_mod", "gcd"};
+  return NAMES[static_cast<size_t>(op)];
+}
+
+std::ostream& operator<<(std::ostream& out, const big_integer_stats& stats) {
+  out << "{\"enabled\": " << (big_integer_stats::enabled ? "true" : "false") << ", \"operations\": {";
+  for (size_t i = 0; i < big_integer_stats::OPERATION_COUNT; ++i) {
+    const big_integer_stats::counters& op = stats.operations[i];
+    out << (i == 0 ? "" : ", ") << '"' << big_integer_stats::name(static_cast<big_integer_stats::operation>(i))
+        << "\": {\"calls\": " << op.calls << ", \"cycles\": " << op.cycles << ", \"allocations\": " << op.allocations
+        << ", \"allocated_bytes\": " << op.allocated_bytes << ", \"size_histogram\": [";
+    for (size_t j = 0; j < big_integer_stats::HISTOGRAM_SIZE; ++j) {
+      out << (j == 0 ? "" : ", ") << op.size_histogram[j];
+    }
+    out << "]}";
+  }
+  return out << "}, \"other_allocations\": " << stats.other_allocations
+             << ", \"other_allocated_bytes\": " << stats.other_allocated_bytes << "}";
+}
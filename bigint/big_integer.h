@@ -1,41 +1,224 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
+#include <iterator>
 #include <limits>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+class big_integer_arena;
+
 struct big_integer {
 public:
-  using data_type = unsigned int;
+  using data_type = uint64_t;
 
 private:
-  static const uint64_t LIMIT = static_cast<uint64_t>(std::numeric_limits<data_type>::max()) + 1;
-  static const uint8_t BITS_COUNT = 32;
-  static const uint32_t STR_NUMS = 1'000'000'000;
-  static const uint32_t STR_NUMS_COUNT = 9;
+  static const uint8_t BITS_COUNT = std::numeric_limits<data_type>::digits;
+  static const uint64_t STR_NUMS = 10'000'000'000'000'000'000ULL;
+  static const uint32_t STR_NUMS_COUNT = 19;
+  // numbers up to this many limbs are converted to and from decimal by the quadratic algorithm
+  static const size_t CONVERSION_THRESHOLD = 64;
+
+  // Limbs of the magnitude, up to SMALL_SIZE of them are stored inline and longer numbers spill to the heap,
+  // or to the arena that was active on this thread when the storage was created
+  class limb_storage {
+  public:
+    static constexpr size_t SMALL_SIZE = 4;
+
+    limb_storage() noexcept;
+    limb_storage(const limb_storage& other);
+    limb_storage(limb_storage&& other) noexcept;
+    limb_storage& operator=(const limb_storage& other);
+    // the move assignment and swap exchange buffers within one arena and copy the limbs between different
+    // ones, which allocates and may throw
+    limb_storage& operator=(limb_storage&& other);
+    ~limb_storage();
+
+    size_t size() const noexcept {
+      return size_;
+    }
+
+    bool empty() const noexcept {
+      return size_ == 0;
+    }
+
+    data_type* data() noexcept {
+      return isSmall() ? buffer_.small_data_ : buffer_.big_data_;
+    }
+
+    const data_type* data() const noexcept {
+      return isSmall() ? buffer_.small_data_ : buffer_.big_data_;
+    }
+
+    data_type* begin() noexcept {
+      return data();
+    }
+
+    data_type* end() noexcept {
+      return data() + size_;
+    }
+
+    const data_type* begin() const noexcept {
+      return data();
+    }
+
+    const data_type* end() const noexcept {
+      return data() + size_;
+    }
+
+    std::reverse_iterator<const data_type*> rbegin() const noexcept {
+      return std::reverse_iterator<const data_type*>(end());
+    }
+
+    std::reverse_iterator<const data_type*> rend() const noexcept {
+      return std::reverse_iterator<const data_type*>(begin());
+    }
+
+    data_type& operator[](size_t i) noexcept {
+      return data()[i];
+    }
+
+    const data_type& operator[](size_t i) const noexcept {
+      return data()[i];
+    }
+
+    data_type& back() noexcept {
+      return data()[size_ - 1];
+    }
+
+    const data_type& back() const noexcept {
+      return data()[size_ - 1];
+    }
 
-  std::vector<data_type> data_;
+    void push_back(data_type value) {
+      if (size_ == capacity_) {
+        reserve(2 * size());
+      }
+      data()[size_++] = value;
+    }
+
+    void pop_back() noexcept {
+      --size_;
+    }
+
+    void reserve(size_t capacity);
+    // new limbs are zero
+    void resize(size_t size);
+    void assign(size_t count, data_type value);
+    void assign(const data_type* first, const data_type* last);
+    void swap(limb_storage& other);
+    // points at size limbs owned by someone else, which are never written to or freed,
+    // any reallocation copies them first
+    void borrow(const data_type* limbs, size_t size) noexcept;
+
+    friend bool operator==(const limb_storage& a, const limb_storage& b) noexcept {
+      return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+  private:
+    union buffer {
+      data_type small_data_[SMALL_SIZE];
+      data_type* big_data_;
+    };
+
+    uint32_t size_;
+    uint32_t capacity_;
+    buffer buffer_;
+    big_integer_arena* arena_;
+
+    bool isSmall() const noexcept {
+      return capacity_ == SMALL_SIZE;
+    }
+
+    bool isBorrowed() const noexcept {
+      return capacity_ == 0;
+    }
+
+    void release() noexcept;
+  };
+
+  limb_storage data_;
   int8_t sign;
   big_integer divide(const big_integer& b);
-  uint64_t divModByConst(uint64_t rhs);
-  void swap(big_integer& other) noexcept;
+  void swap(big_integer& other);
   void deleteLeadingZeroes();
-  int normalize();
   void make(uint64_t value);
-  void invert();
-  void back_invert();
   void divByConst(uint64_t rhs);
-  void mulByConst(uint64_t rhs);
-  void subtract(const big_integer& rhs);
+  // |*this| += |rhs|
+  void addMagnitude(const big_integer& rhs);
+  // |*this| = ||*this| - |rhs||, the sign becomes rhs_sign if |rhs| is the larger one
+  void subtract(const big_integer& rhs, int8_t rhs_sign);
+  // *this += value * value_sign, reallocates only when the carry runs past the top limb
+  void addSmall(uint64_t value, int8_t value_sign);
+  // -1, 0 or 1 as |*this| is less than, equal to or greater than |rhs|
+  int compareMagnitude(const big_integer& rhs) const noexcept;
   bool isZero() const noexcept;
   template <typename Operation>
   void bitwiseOp(const big_integer& other, Operation op);
+  // *this += a * b * product_sign
+  void addProduct(const big_integer& a, const big_integer& b, int8_t product_sign);
+
+  static void mulMagnitude(data_type* r, const data_type* a, size_t an, const data_type* b, size_t bn);
+  static void mulKaratsuba(data_type* r, const data_type* a, size_t an, const data_type* b, size_t bn);
+  static void mulToom3(data_type* r, const data_type* a, size_t an, const data_type* b, size_t bn);
+
+  static big_integer fromLimbs(const data_type* first, size_t n);
+  // floor(B^2n / v) for a normalized n-limb v
+  static big_integer reciprocal(const big_integer& v, size_t n);
+  static void divNewton(data_type* q, data_type* u, size_t un, const data_type* v, size_t n);
+
+  // product of the Euclid steps taken by the half-GCD, (a, b) = M (a', b') and det M = 1
+  struct hgcd_matrix;
+  static size_t bitLength(const big_integer& x) noexcept;
+  // Steps reducing the larger of a, b > 0 as long as both of them and their difference stay at least 2^s,
+  // false if there is no such step. The Lehmer step works on the top 62 bits and makes about 30 bits
+  // of progress at once, the division step is the exact fallback; with s == 0 they run plain Euclid.
+  static bool lehmerStep(big_integer& a, big_integer& b, size_t s, hgcd_matrix* m, std::vector<data_type>& scratch);
+  static bool divisionStep(big_integer& a, big_integer& b, size_t s, hgcd_matrix* m);
+  // Möller's half-GCD: reduces a, b of n bits until they are about n / 2 bits long
+  static bool hgcd(big_integer& a, big_integer& b, hgcd_matrix& m);
+  // runs Euclid on a, b >= 0 until one of them is zero, m accumulates the steps if given
+  static void gcdReduce(big_integer& a, big_integer& b, hgcd_matrix* m);
+  // floor(sqrt(n)) for n >= 0, rem = n - floor(sqrt(n))^2
+  static big_integer sqrtRem(const big_integer& n, big_integer& rem);
+  // floor(n^(1/k)) for n >= 0 and k >= 3
+  static big_integer rootMagnitude(const big_integer& n, uint64_t k);
+
+  // 10^(STR_NUMS_COUNT * 2^k), computed once and cached
+  static const big_integer& powerOfTen(size_t k);
+  // writes exactly STR_NUMS_COUNT * 2^k digits of |x| < 10^(STR_NUMS_COUNT * 2^k)
+  static void writePadded(const big_integer& x, char* out, size_t k);
+  // writes |x| without leading zeroes, returns nullptr if it doesn't fit into [first, last)
+  static char* writeLeading(const big_integer& x, char* first, char* last);
+  static big_integer parseDigits(const char* first, size_t len);
 
 public:
+  // Multiplication switches from schoolbook to Karatsuba, then to Toom-3 and then to
+  // the number-theoretic transform once the shorter operand reaches the given number of limbs.
+  static size_t karatsuba_threshold;
+  static size_t toom3_threshold;
+  static size_t ntt_threshold;
+  // Division switches from Knuth's algorithm D to Barrett reduction by a Newton reciprocal
+  // once both the divisor and the quotient reach this number of limbs.
+  static size_t newton_threshold;
+  // GCD switches from Lehmer's algorithm to the subquadratic half-GCD once the operands reach this number of limbs.
+  static size_t hgcd_threshold;
+  // Parallel mode: with thread_count > 1 the subproblems of Karatsuba, Toom-3 and NTT products and the halves
+  // of decimal conversions are spread over a shared work-stealing pool of that many threads once the operands
+  // reach parallel_threshold limbs. Both have to be set before any computation runs.
+  static size_t thread_count;
+  static size_t parallel_threshold;
+
   big_integer() noexcept;
   big_integer(const big_integer& other);
+  big_integer(big_integer&& other) noexcept;
   big_integer(int a);
   big_integer(unsigned int a);
   big_integer(long a);
@@ -46,9 +229,35 @@ public:
   ~big_integer();
 
   big_integer& operator=(const big_integer& other) noexcept;
+  // copies the limbs when other belongs to another arena, so unlike the move constructor it may throw
+  big_integer& operator=(big_integer&& other);
   big_integer& operator+=(const big_integer& rhs);
-  big_integer& operator+=(uint64_t rhs);
   big_integer& operator-=(const big_integer& rhs);
+  // machine integers are added in place without being converted to big_integer first
+  template <std::integral T>
+    requires(sizeof(T) <= sizeof(uint64_t))
+  big_integer& operator+=(T rhs) {
+    if constexpr (std::is_signed_v<T>) {
+      if (rhs < 0) {
+        addSmall(-static_cast<uint64_t>(rhs), -1);
+        return *this;
+      }
+    }
+    addSmall(static_cast<uint64_t>(rhs), 1);
+    return *this;
+  }
+  template <std::integral T>
+    requires(sizeof(T) <= sizeof(uint64_t))
+  big_integer& operator-=(T rhs) {
+    if constexpr (std::is_signed_v<T>) {
+      if (rhs < 0) {
+        addSmall(-static_cast<uint64_t>(rhs), 1);
+        return *this;
+      }
+    }
+    addSmall(static_cast<uint64_t>(rhs), -1);
+    return *this;
+  }
   big_integer& operator*=(const big_integer& rhs);
   big_integer& operator/=(const big_integer& rhs);
   big_integer& operator%=(const big_integer& rhs);
@@ -78,20 +287,62 @@ public:
   friend bool operator>=(const big_integer& a, const big_integer& b) noexcept;
 
   friend std::string to_string(const big_integer& a);
+  friend std::to_chars_result to_chars(char* first, char* last, const big_integer& value);
+  friend std::from_chars_result from_chars(const char* first, const char* last, big_integer& value);
+
+  friend size_t export_words(const big_integer& value, size_t word_size) noexcept;
+  friend size_t export_bytes(const big_integer& value, void* out, size_t word_size, std::endian word_order,
+                             std::endian byte_order);
+  friend big_integer import_bytes(const void* in, size_t count, size_t word_size, std::endian word_order,
+                                  std::endian byte_order);
+  friend char* serialize(const big_integer& value, char* out);
+
+  friend class big_integer_view;
+  friend class montgomery_context;
+  friend big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod);
+  friend void addmul(big_integer& acc, const big_integer& a, const big_integer& b);
+  friend void submul(big_integer& acc, const big_integer& a, const big_integer& b);
+  friend big_integer mul_mod(const big_integer& a, const big_integer& b, const big_integer& mod);
+  friend big_integer gcd(const big_integer& a, const big_integer& b);
+  friend big_integer xgcd(const big_integer& a, const big_integer& b, big_integer& x, big_integer& y);
+  friend big_integer mod_inverse(const big_integer& a, const big_integer& mod);
+  friend big_integer pow(const big_integer& base, uint64_t exp);
+  friend big_integer iroot(const big_integer& n, uint64_t k);
 };
 
+// Overloads taking an rvalue build the result in its limbs instead of copying the other operand
 big_integer operator+(const big_integer& a, const big_integer& b);
+big_integer operator+(big_integer&& a, const big_integer& b);
+big_integer operator+(const big_integer& a, big_integer&& b);
+big_integer operator+(big_integer&& a, big_integer&& b);
 big_integer operator-(const big_integer& a, const big_integer& b);
+big_integer operator-(big_integer&& a, const big_integer& b);
 big_integer operator*(const big_integer& a, const big_integer& b);
+big_integer operator*(big_integer&& a, const big_integer& b);
+big_integer operator*(const big_integer& a, big_integer&& b);
+big_integer operator*(big_integer&& a, big_integer&& b);
 big_integer operator/(const big_integer& a, const big_integer& b);
+big_integer operator/(big_integer&& a, const big_integer& b);
 big_integer operator%(const big_integer& a, const big_integer& b);
+big_integer operator%(big_integer&& a, const big_integer& b);
 
 big_integer operator&(const big_integer& a, const big_integer& b);
+big_integer operator&(big_integer&& a, const big_integer& b);
+big_integer operator&(const big_integer& a, big_integer&& b);
+big_integer operator&(big_integer&& a, big_integer&& b);
 big_integer operator|(const big_integer& a, const big_integer& b);
+big_integer operator|(big_integer&& a, const big_integer& b);
+big_integer operator|(const big_integer& a, big_integer&& b);
+big_integer operator|(big_integer&& a, big_integer&& b);
 big_integer operator^(const big_integer& a, const big_integer& b);
+big_integer operator^(big_integer&& a, const big_integer& b);
+big_integer operator^(const big_integer& a, big_integer&& b);
+big_integer operator^(big_integer&& a, big_integer&& b);
 
 big_integer operator<<(const big_integer& a, int b);
+big_integer operator<<(big_integer&& a, int b);
 big_integer operator>>(const big_integer& a, int b);
+big_integer operator>>(big_integer&& a, int b);
 
 bool operator==(const big_integer& a, const big_integer& b) noexcept;
 bool operator!=(const big_integer& a, const big_integer& b) noexcept;
@@ -100,5 +351,163 @@ bool operator>(const big_integer& a, const big_integer& b) noexcept;
 bool operator<=(const big_integer& a, const big_integer& b) noexcept;
 bool operator>=(const big_integer& a, const big_integer& b) noexcept;
 
+// acc += a * b and acc -= a * b, small products are accumulated straight into the limbs of acc
+// and larger ones go through a single scratch buffer instead of big_integer temporaries
+void addmul(big_integer& acc, const big_integer& a, const big_integer& b);
+void submul(big_integer& acc, const big_integer& a, const big_integer& b);
+// a * b mod |mod| in [0, |mod|), the product is reduced in place
+big_integer mul_mod(const big_integer& a, const big_integer& b, const big_integer& mod);
+
+// gcd(|a|, |b|), which is 0 only for two zeroes
+big_integer gcd(const big_integer& a, const big_integer& b);
+// gcd(a, b) along with x and y such that a * x + b * y = gcd(a, b)
+big_integer xgcd(const big_integer& a, const big_integer& b, big_integer& x, big_integer& y);
+// a^-1 mod |mod| in [0, |mod|), throws std::invalid_argument if a and mod are not coprime
+big_integer mod_inverse(const big_integer& a, const big_integer& mod);
+
+// base^exp by left-to-right binary exponentiation, products of a number with itself take the squaring kernels
+big_integer pow(const big_integer& base, uint64_t exp);
+// Roots rounded toward zero by Newton's iteration on a root of the top bits, so that only the last one or two
+// iterations run at full precision. They throw std::invalid_argument for k == 0 and even roots of negatives.
+big_integer isqrt(const big_integer& n);
+big_integer iroot(const big_integer& n, uint64_t k);
+
 std::string to_string(const big_integer& a);
+// Same contract as std::to_chars/std::from_chars for base 10, no intermediate strings are built
+// and numbers below CONVERSION_THRESHOLD limbs are written without touching the heap.
+std::to_chars_result to_chars(char* first, char* last, const big_integer& value);
+std::from_chars_result from_chars(const char* first, const char* last, big_integer& value);
 std::ostream& operator<<(std::ostream& out, const big_integer& a);
+
+// The magnitude laid out like GMP's mpz_export/mpz_import: words of word_size bytes going from the least
+// significant one if word_order is little, every word with its bytes in byte_order. The sign is not stored.
+// export_words is the number of words export_bytes writes and returns, zero takes none.
+size_t export_words(const big_integer& value, size_t word_size) noexcept;
+size_t export_bytes(const big_integer& value, void* out, size_t word_size,
+                    std::endian word_order = std::endian::little, std::endian byte_order = std::endian::native);
+big_integer import_bytes(const void* in, size_t count, size_t word_size,
+                         std::endian word_order = std::endian::little, std::endian byte_order = std::endian::native);
+
+// Checkpoint format: the magic "BIGI", a 32-bit flags word with the sign in bit 0, a 64-bit limb count and then
+// the 64-bit limbs of the magnitude from the least significant one, all little-endian. Every record takes
+// a multiple of 8 bytes, so records written back to back keep the limbs aligned.
+size_t serialized_size(const big_integer& value) noexcept;
+// writes serialized_size(value) bytes, returns the end of the record
+char* serialize(const big_integer& value, char* out);
+
+// Read-only number over a serialized record, typically in a memory-mapped file. On little-endian hosts
+// aligned limbs are used in place, so the record has to outlive the view and stay unchanged; otherwise they
+// are copied. Copies of a view share the record as well.
+class big_integer_view {
+public:
+  // throws std::invalid_argument unless [data, data + size) starts with a whole record
+  big_integer_view(const char* data, size_t size);
+  big_integer_view(const big_integer_view& other);
+  big_integer_view& operator=(const big_integer_view& other);
+
+  const big_integer& value() const noexcept;
+  operator const big_integer&() const noexcept;
+  // bytes taken by the record, the next one starts right after it
+  size_t size() const noexcept;
+
+private:
+  const char* data_;
+  size_t size_;
+  big_integer value_;
+
+  void wrap(size_t available);
+};
+
+// Montgomery arithmetic modulo a fixed odd m > 0. R^2 mod m and -m^-1 mod B are computed once,
+// so that a series of exponentiations by the same modulus pays for the division only once.
+class montgomery_context {
+public:
+  explicit montgomery_context(const big_integer& mod);
+
+  const big_integer& modulus() const noexcept;
+  // base^exp mod m in [0, m) by sliding window exponentiation, exp must be non-negative
+  big_integer pow(const big_integer& base, const big_integer& exp) const;
+
+private:
+  using data_type = big_integer::data_type;
+
+  big_integer mod_;
+  std::vector<data_type> r2_;
+  data_type inv_;
+};
+
+// base^exp mod |mod| in [0, |mod|), exp must be non-negative
+big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod);
+
+// Per-operation counters, compiled in only when BIGINT_STATS is defined and free otherwise, then every snapshot
+// is zero. Operations called by other ones are counted too, except an operation nested in itself. Allocations
+// go to the innermost running operation and cycles include nested operations; cycles are TSC ticks on x86
+// and nanoseconds elsewhere.
+struct big_integer_stats {
+  enum class operation { add, subtract, multiply, divide, shift, bitwise, to_string, from_string, pow_mod, gcd };
+  static constexpr size_t OPERATION_COUNT = 10;
+  // bucket i counts operands of [2^(i - 1), 2^i) limbs, the size is the one the thresholds look at:
+  // the shorter factor of a product, the divisor of a division and the longer operand otherwise
+  static constexpr size_t HISTOGRAM_SIZE = 33;
+
+  struct counters {
+    uint64_t calls;
+    uint64_t cycles;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t size_histogram[HISTOGRAM_SIZE];
+  };
+
+#ifdef BIGINT_STATS
+  static constexpr bool enabled = true;
+#else
+  static constexpr bool enabled = false;
+#endif
+
+  counters operations[OPERATION_COUNT] = {};
+  // limbs allocated outside of any operation, mostly by copies
+  uint64_t other_allocations = 0;
+  uint64_t other_allocated_bytes = 0;
+
+  // counters of all threads so far
+  static big_integer_stats snapshot();
+  static void reset();
+  static const char* name(operation op) noexcept;
+};
+
+// JSON object with an entry per operation
+std::ostream& operator<<(std::ostream& out, const big_integer_stats& stats);
+
+// Numbers created on this thread while an arena is alive take their long limb buffers from the arena's
+// blocks, and the destructor frees all of them at once. Arenas nest, the innermost one is used. A number
+// constructed by a move keeps the memory of the source, moving into an existing number that belongs to
+// another arena or to the heap copies it, so outer numbers never point into the arena, but numbers
+// created inside must be destroyed before it.
+class big_integer_arena {
+public:
+  explicit big_integer_arena(size_t block_size = 1 << 16);
+  big_integer_arena(const big_integer_arena&) = delete;
+  big_integer_arena& operator=(const big_integer_arena&) = delete;
+  ~big_integer_arena();
+
+  // bytes aligned for limbs, rounded up to at most 5/4 of the request
+  void* allocate(size_t bytes);
+  // p goes to the free list of its size, so that short-lived temporaries keep reusing the same memory
+  void deallocate(void* p, size_t bytes) noexcept;
+
+private:
+  struct block {
+    block* next;
+  };
+
+  struct free_node {
+    free_node* next;
+  };
+
+  size_t block_size_;
+  block* blocks_;
+  char* current_;
+  char* end_;
+  free_node* free_[4 * std::numeric_limits<size_t>::digits];
+  big_integer_arena* previous_;
+};
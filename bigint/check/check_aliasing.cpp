@@ -0,0 +1,39 @@
+#include "check_utils.h"
+
+#include <functional>
+#include <utility>
+
+// Every compound assignment with the same number on both sides has to give the result for a distinct copy of it
+int main() {
+  const std::pair<const char*, std::function<void(big_integer&, const big_integer&)>> ops[] = {
+      {"+=", [](big_integer& a, const big_integer& b) { a += b; }},
+      {"-=", [](big_integer& a, const big_integer& b) { a -= b; }},
+      {"*=", [](big_integer& a, const big_integer& b) { a *= b; }},
+      {"/=", [](big_integer& a, const big_integer& b) { a /= b; }},
+      {"%=", [](big_integer& a, const big_integer& b) { a %= b; }},
+      {"&=", [](big_integer& a, const big_integer& b) { a &= b; }},
+      {"|=", [](big_integer& a, const big_integer& b) { a |= b; }},
+      {"^=", [](big_integer& a, const big_integer& b) { a ^= b; }},
+  };
+
+  for (size_t limbs : {1, 2, 3, 4, 5, 8, 9, 40}) {
+    for (size_t i = 0; i < 20; ++i) {
+      const big_integer value = random_signed(limbs);
+      for (const auto& [name, op] : ops) {
+        big_integer self = value;
+        op(self, self);
+        big_integer expected = value;
+        op(expected, big_integer(value));
+        expect(self == expected, "x " + std::string(name) + " x for x = " + to_string(value));
+      }
+
+      big_integer quotient = value;
+      quotient /= quotient;
+      expect(quotient == 1, "x /= x is not 1 for x = " + to_string(value));
+      big_integer remainder = value;
+      remainder %= remainder;
+      expect(remainder == 0, "x %= x is not 0 for x = " + to_string(value));
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
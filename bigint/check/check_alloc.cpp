@@ -0,0 +1,107 @@
+#include "check_utils.h"
+
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <utility>
+
+namespace {
+size_t allocations = 0;
+
+// heap allocations made by count calls of f
+size_t allocations_of(const std::function<void()>& f, size_t count) {
+  size_t before = allocations;
+  for (size_t i = 0; i < count; ++i) {
+    f();
+  }
+  return allocations - before;
+}
+} // namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+// Temporaries are recycled: a number that is updated over and over stops allocating once its buffer is large
+// enough, and the intermediate results of an expression lend their limbs to the next operator
+int main() {
+  constexpr size_t REPEATS = 1000;
+
+  for (size_t limbs : {1, 2, 4, 8, 32}) {
+    const big_integer a = random_number(limbs);
+    const big_integer b = -random_number(limbs);
+    big_integer x;
+    big_integer c;
+
+    const std::pair<const char*, std::function<void()>> steady[] = {
+        {"x = a; x = b", [&] {
+           x = a;
+           x = b;
+         }},
+        {"x += a; x -= a", [&] {
+           x += a;
+           x -= a;
+         }},
+        {"x -= b; x += b", [&] {
+           x -= b;
+           x += b;
+         }},
+        {"++x; --x", [&] {
+           ++x;
+           --x;
+         }},
+        {"x <<= 7; x >>= 7", [&] {
+           x <<= 7;
+           x >>= 7;
+         }},
+        {"x &= a; x |= b; x ^= a", [&] {
+           x &= a;
+           x |= b;
+           x ^= a;
+         }},
+    };
+    for (const auto& [name, op] : steady) {
+      x = a;
+      // the first calls may grow the buffer
+      allocations_of(op, 2);
+      size_t count = allocations_of(op, REPEATS);
+      expect(count == 0, std::string(name) + " allocated " + std::to_string(count) + " times in " +
+                             std::to_string(REPEATS) + " repetitions with " + std::to_string(limbs) + " limbs");
+    }
+
+    // every expression allocates no more than the operations that need a fresh buffer, which are listed second
+    const std::pair<std::pair<const char*, std::function<void()>>, std::function<void()>> chains[] = {
+        {{"(a + b) * a - b", [&] { c = (a + b) * a - b; }}, [&] { c = (a + b) * a; }},
+        {{"a * b + b * a", [&] { c = a * b + b * a; }}, [&] {
+           c = a * b;
+           c = b * a;
+         }},
+        {{"-(a - b) + a + b", [&] { c = -(a - b) + a + b; }}, [&] { c = a - b; }},
+        {{"((a & b) | a) ^ b", [&] { c = ((a & b) | a) ^ b; }}, [&] { c = a & b; }},
+        {{"(a + 1) * b % a", [&] { c = (a + 1) * b % a; }}, [&] {
+           c = (a + 1) * b;
+           c %= a;
+         }},
+    };
+    for (const auto& [chain, fresh] : chains) {
+      size_t count = allocations_of(chain.second, REPEATS);
+      size_t expected = allocations_of(fresh, REPEATS);
+      expect(count <= expected, std::string(chain.first) + " allocated " + std::to_string(count) + " times in " +
+                                    std::to_string(REPEATS) + " repetitions with " + std::to_string(limbs) +
+                                    " limbs instead of at most " + std::to_string(expected));
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+#include "check_utils.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Numbers that are moved while an arena is active keep their memory, so they outlive the arena
+int main() {
+  std::vector<big_integer> outer;
+  std::vector<big_integer> expected;
+  for (size_t i = 0; i < 8; ++i) {
+    outer.push_back(random_signed(8 + i));
+    expected.push_back(outer.back());
+  }
+
+  {
+    big_integer_arena arena;
+    // reallocation move-constructs the heap numbers into the new buffer
+    outer.reserve(4 * outer.capacity());
+    auto moved = std::make_unique<big_integer>(std::move(outer[0]));
+    outer[0] = std::move(*moved);
+
+    big_integer inner = random_signed(16);
+    big_integer product = inner * inner;
+    big_integer from_inner(std::move(product));
+    expect(from_inner == inner * inner, "a number moved inside an arena changed");
+  }
+
+  for (size_t i = 0; i < outer.size(); ++i) {
+    outer[i] += 1;
+    expect(outer[i] == expected[i] + 1, "number " + std::to_string(i) + " changed after the arena was destroyed");
+  }
+  return failures == 0 ? 0 : 1;
+}
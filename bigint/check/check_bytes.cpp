@@ -0,0 +1,25 @@
+#include "check_utils.h"
+
+#include <cstring>
+
+// import_bytes(export_bytes(x)) == |x| for every word size and order, zero goes through null buffers
+int main() {
+  const std::endian orders[] = {std::endian::little, std::endian::big};
+  for (size_t limbs : {0, 1, 2, 5, 9}) {
+    const big_integer value = random_number(limbs);
+    for (size_t word_size : {1, 3, 4, 8, 16}) {
+      for (std::endian word_order : orders) {
+        for (std::endian byte_order : orders) {
+          size_t words = export_words(value, word_size);
+          unsigned char* buffer = words == 0 ? nullptr : new unsigned char[words * word_size];
+          expect(export_bytes(value, buffer, word_size, word_order, byte_order) == words,
+                 "export_bytes wrote another number of words than export_words for " + to_string(value));
+          expect(import_bytes(buffer, words, word_size, word_order, byte_order) == value,
+                 "round trip through " + std::to_string(word_size) + "-byte words changed " + to_string(value));
+          delete[] buffer;
+        }
+      }
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include "check_utils.h"
+
+#include <thread>
+#include <vector>
+
+// Decimal conversions from several threads at once in parallel mode: the halves of a conversion run on the pool
+// and grow the shared cache of powers of ten while other threads read it
+int main() {
+  big_integer::thread_count = 4;
+  big_integer::parallel_threshold = 16;
+  // squares of the cached powers go to the pool from a few limbs on
+  big_integer::karatsuba_threshold = 8;
+
+  constexpr size_t THREADS = 4;
+  constexpr size_t SIZES = 24;
+  // every thread walks through growing lengths, so the cache keeps growing while the others convert
+  std::vector<big_integer> numbers;
+  std::vector<std::string> expected;
+  for (size_t i = 0; i < SIZES; ++i) {
+    numbers.push_back(random_signed(20 + 60 * i));
+  }
+  // expected strings from the quadratic conversion, which never touches the pool or the cache
+  for (const big_integer& number : numbers) {
+    std::string digits;
+    big_integer rest = number < 0 ? -number : number;
+    while (rest != 0) {
+      uint64_t digit = 0;
+      export_bytes(rest % 10, &digit, sizeof(digit), std::endian::little, std::endian::little);
+      digits += static_cast<char>('0' + digit);
+      rest /= 10;
+    }
+    expected.emplace_back((number < 0 ? "-" : "") + std::string(digits.rbegin(), digits.rend()));
+  }
+
+  std::vector<size_t> thread_failures(THREADS);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < SIZES; ++i) {
+        const big_integer& number = numbers[(i + t) % SIZES];
+        const std::string& digits = expected[(i + t) % SIZES];
+        thread_failures[t] += to_string(number) != digits;
+        thread_failures[t] += big_integer(digits) != number;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (size_t t = 0; t < THREADS; ++t) {
+    expect(thread_failures[t] == 0, "thread " + std::to_string(t) + " converted " +
+                                         std::to_string(thread_failures[t]) + " numbers wrongly");
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+#include "check_utils.h"
+
+#include <limits>
+
+namespace {
+struct thresholds {
+  const char* name;
+  size_t karatsuba;
+  size_t toom3;
+  size_t ntt;
+};
+
+constexpr size_t NEVER = std::numeric_limits<size_t>::max();
+
+void use(const thresholds& t) {
+  big_integer::karatsuba_threshold = t.karatsuba;
+  big_integer::toom3_threshold = t.toom3;
+  big_integer::ntt_threshold = t.ntt;
+}
+
+// Operand lengths up to 300 limbs: balanced, unbalanced and with a short side
+size_t random_length(size_t max) {
+  return 1 + rng()() % max;
+}
+} // namespace
+
+// Every multiplication tier, switched on at a few limbs so that it runs on all lengths and recursion levels,
+// against the schoolbook product
+int main() {
+  // the subproducts of the tiers also go through the thread pool
+  big_integer::thread_count = 4;
+  big_integer::parallel_threshold = 16;
+
+  const thresholds schoolbook = {"schoolbook", NEVER, NEVER, NEVER};
+  const thresholds tiers[] = {
+      {"karatsuba", 4, NEVER, NEVER},
+      {"toom-3", 4, 9, NEVER},
+      {"ntt", 4, 9, 4},
+      {"mixed", 4, 12, 48},
+  };
+
+  for (const thresholds& tier : tiers) {
+    for (size_t i = 0; i < 300; ++i) {
+      size_t an = random_length(300);
+      big_integer a = random_signed(an);
+      big_integer b = random_signed(i % 3 == 0 ? random_length(an) : random_length(300));
+      big_integer acc = random_signed(random_length(600));
+
+      use(schoolbook);
+      big_integer product = a * b;
+      big_integer square = a * a;
+      big_integer sum = acc + product;
+      big_integer difference = acc - product;
+
+      use(tier);
+      std::string operands = std::string(tier.name) + " for " + to_string(a) + " and " + to_string(b);
+      expect(a * b == product, "a * b with " + operands);
+      expect(b * a == product, "b * a with " + operands);
+      expect(a * big_integer(a) == square, "a * copy of a with " + operands);
+      big_integer self = a;
+      self *= self;
+      expect(self == square, "a *= a with " + operands);
+      big_integer fused = acc;
+      addmul(fused, a, b);
+      expect(fused == sum, "addmul with " + operands);
+      fused = acc;
+      submul(fused, a, b);
+      expect(fused == difference, "submul with " + operands);
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
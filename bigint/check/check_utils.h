@@ -0,0 +1,54 @@
+#pragma once
+
+#include "big_integer.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+inline constexpr size_t LIMB_BITS = std::numeric_limits<big_integer::data_type>::digits;
+
+inline size_t failures = 0;
+
+// Reports a failed condition, the program exits with failures != 0
+inline void expect(bool condition, const std::string& what) {
+  if (!condition) {
+    ++failures;
+    std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+  }
+}
+
+inline std::mt19937_64& rng() {
+  static std::mt19937_64 engine(42);
+  return engine;
+}
+
+// limbs random limbs, with runs of all zero and all one bits mixed in so that carries and borrows propagate
+inline big_integer random_number(size_t limbs) {
+  std::vector<uint64_t> words(limbs);
+  for (uint64_t& word : words) {
+    switch (rng()() % 8) {
+    case 0:
+      word = 0;
+      break;
+    case 1:
+      word = ~uint64_t(0);
+      break;
+    default:
+      word = rng()();
+    }
+  }
+  if (limbs != 0 && words.back() == 0) {
+    words.back() = 1;
+  }
+  return import_bytes(words.data(), words.size(), sizeof(uint64_t), std::endian::little);
+}
+
+inline big_integer random_signed(size_t limbs) {
+  big_integer result = random_number(limbs);
+  return rng()() % 2 == 0 ? result : -result;
+}
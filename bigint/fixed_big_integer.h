@@ -0,0 +1,409 @@
+#pragma once
+
+#include "big_integer.h"
+#include "limb_division.h"
+
+#include <bit>
+#include <charconv>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Signed integer of Bits bits in two's complement that wraps around like the built-in types. The limbs live
+// inline, so nothing touches the heap, and the loops of the linear operations and of the product are
+// unrolled over the compile-time limb count. Division truncates toward zero and shifts are arithmetic,
+// as for big_integer, with which every value of the range converts back and forth.
+template <size_t Bits>
+  requires(Bits > 0 && Bits % 64 == 0)
+struct fixed_big_integer {
+public:
+  using data_type = uint64_t;
+  static constexpr size_t LIMBS = Bits / 64;
+
+private:
+  static constexpr uint8_t BITS_COUNT = 64;
+  static constexpr uint64_t STR_NUMS = 10'000'000'000'000'000'000ULL;
+  static constexpr uint32_t STR_NUMS_COUNT = 19;
+  // log10(2) < 1234 / 4096, the decimal digits are written in whole chunks with room for the sign
+  static constexpr size_t MAX_CHARS = ((Bits * 1234 / 4096 + 1) / STR_NUMS_COUNT + 1) * STR_NUMS_COUNT + 1;
+
+  __extension__ using uint128_t = unsigned __int128;
+
+  data_type data_[LIMBS] = {};
+
+  // calls f(std::integral_constant<size_t, i>()) for i in [0, N) without a loop
+  template <size_t N, typename F>
+  static constexpr void unroll(F&& f) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      (f(std::integral_constant<size_t, I>()), ...);
+    }(std::make_index_sequence<N>());
+  }
+
+public:
+  constexpr fixed_big_integer() noexcept = default;
+
+  template <std::integral T>
+  constexpr fixed_big_integer(T value) noexcept {
+    data_type fill = (std::is_signed_v<T> && value < 0) ? ~data_type(0) : 0;
+    data_[0] = static_cast<data_type>(value);
+    for (size_t i = 1; i < LIMBS; ++i) {
+      data_[i] = fill;
+    }
+  }
+
+  // keeps the low Bits bits of the two's complement of value
+  explicit fixed_big_integer(const big_integer& value) {
+    big_integer magnitude = value < 0 ? -value : value;
+    if (export_words(magnitude, sizeof(data_type)) > LIMBS) {
+      magnitude &= (big_integer(1) << static_cast<int>(Bits)) - 1;
+    }
+    export_bytes(magnitude, data_, sizeof(data_type));
+    if (value < 0) {
+      negate();
+    }
+  }
+
+  explicit fixed_big_integer(const std::string& str) {
+    const char* last = str.data() + str.size();
+    if (from_chars(str.data(), last, *this).ptr != last) {
+      throw std::invalid_argument("biginteger can't contains non-integer values");
+    }
+  }
+
+  explicit operator big_integer() const {
+    fixed_big_integer magnitude = isNegative() ? -*this : *this;
+    big_integer res = import_bytes(magnitude.data_, LIMBS, sizeof(data_type));
+    return isNegative() ? -res : res;
+  }
+
+  constexpr const data_type* data() const noexcept {
+    return data_;
+  }
+
+  constexpr bool isNegative() const noexcept {
+    return (data_[LIMBS - 1] >> (BITS_COUNT - 1)) != 0;
+  }
+
+  constexpr bool isZero() const noexcept {
+    data_type any = 0;
+    unroll<LIMBS>([&](auto i) { any |= data_[i]; });
+    return any == 0;
+  }
+
+  constexpr fixed_big_integer& operator+=(const fixed_big_integer& rhs) noexcept {
+    bool carry = false;
+    unroll<LIMBS>([&](auto i) {
+      bool overflow = __builtin_add_overflow(data_[i], rhs.data_[i], &data_[i]);
+      carry = __builtin_add_overflow(data_[i], carry, &data_[i]) || overflow;
+    });
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator-=(const fixed_big_integer& rhs) noexcept {
+    bool borrow = false;
+    unroll<LIMBS>([&](auto i) {
+      bool overflow = __builtin_sub_overflow(data_[i], rhs.data_[i], &data_[i]);
+      borrow = __builtin_sub_overflow(data_[i], borrow, &data_[i]) || overflow;
+    });
+    return *this;
+  }
+
+  // the low half of the schoolbook product is the same for signed and unsigned operands
+  constexpr fixed_big_integer& operator*=(const fixed_big_integer& rhs) noexcept {
+    fixed_big_integer res;
+    unroll<LIMBS>([&](auto i) {
+      data_type carry = 0;
+      unroll<LIMBS - decltype(i)::value>([&](auto j) {
+        uint128_t cur = static_cast<uint128_t>(data_[i]) * rhs.data_[j] + res.data_[i + j] + carry;
+        res.data_[i + j] = static_cast<data_type>(cur);
+        carry = static_cast<data_type>(cur >> BITS_COUNT);
+      });
+    });
+    *this = res;
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator/=(const fixed_big_integer& rhs) {
+    fixed_big_integer rem;
+    divide(rhs, *this, rem);
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator%=(const fixed_big_integer& rhs) {
+    fixed_big_integer quotient;
+    divide(rhs, quotient, *this);
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator&=(const fixed_big_integer& rhs) noexcept {
+    unroll<LIMBS>([&](auto i) { data_[i] &= rhs.data_[i]; });
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator|=(const fixed_big_integer& rhs) noexcept {
+    unroll<LIMBS>([&](auto i) { data_[i] |= rhs.data_[i]; });
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator^=(const fixed_big_integer& rhs) noexcept {
+    unroll<LIMBS>([&](auto i) { data_[i] ^= rhs.data_[i]; });
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator<<=(int rhs) noexcept {
+    size_t limbs = static_cast<size_t>(rhs) / BITS_COUNT;
+    unsigned shift = static_cast<unsigned>(rhs) % BITS_COUNT;
+    for (size_t i = LIMBS; i-- > 0;) {
+      data_type cur = i >= limbs ? data_[i - limbs] << shift : 0;
+      if (shift != 0 && i > limbs) {
+        cur |= data_[i - limbs - 1] >> (BITS_COUNT - shift);
+      }
+      data_[i] = cur;
+    }
+    return *this;
+  }
+
+  constexpr fixed_big_integer& operator>>=(int rhs) noexcept {
+    data_type fill = isNegative() ? ~data_type(0) : 0;
+    size_t limbs = static_cast<size_t>(rhs) / BITS_COUNT;
+    unsigned shift = static_cast<unsigned>(rhs) % BITS_COUNT;
+    for (size_t i = 0; i < LIMBS; ++i) {
+      data_type low = i + limbs < LIMBS ? data_[i + limbs] : fill;
+      data_type high = i + limbs + 1 < LIMBS ? data_[i + limbs + 1] : fill;
+      data_[i] = shift == 0 ? low : (low >> shift) | (high << (BITS_COUNT - shift));
+    }
+    return *this;
+  }
+
+  constexpr fixed_big_integer operator+() const noexcept {
+    return *this;
+  }
+
+  constexpr fixed_big_integer operator-() const noexcept {
+    fixed_big_integer res = *this;
+    res.negate();
+    return res;
+  }
+
+  constexpr fixed_big_integer operator~() const noexcept {
+    fixed_big_integer res;
+    unroll<LIMBS>([&](auto i) { res.data_[i] = ~data_[i]; });
+    return res;
+  }
+
+  constexpr fixed_big_integer& operator++() noexcept {
+    for (size_t i = 0; i < LIMBS && ++data_[i] == 0; ++i) {
+    }
+    return *this;
+  }
+
+  constexpr fixed_big_integer operator++(int) noexcept {
+    fixed_big_integer old = *this;
+    ++*this;
+    return old;
+  }
+
+  constexpr fixed_big_integer& operator--() noexcept {
+    for (size_t i = 0; i < LIMBS && data_[i]-- == 0; ++i) {
+    }
+    return *this;
+  }
+
+  constexpr fixed_big_integer operator--(int) noexcept {
+    fixed_big_integer old = *this;
+    --*this;
+    return old;
+  }
+
+  friend constexpr fixed_big_integer operator+(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a += b;
+  }
+
+  friend constexpr fixed_big_integer operator-(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a -= b;
+  }
+
+  friend constexpr fixed_big_integer operator*(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a *= b;
+  }
+
+  friend constexpr fixed_big_integer operator/(fixed_big_integer a, const fixed_big_integer& b) {
+    return a /= b;
+  }
+
+  friend constexpr fixed_big_integer operator%(fixed_big_integer a, const fixed_big_integer& b) {
+    return a %= b;
+  }
+
+  friend constexpr fixed_big_integer operator&(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a &= b;
+  }
+
+  friend constexpr fixed_big_integer operator|(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a |= b;
+  }
+
+  friend constexpr fixed_big_integer operator^(fixed_big_integer a, const fixed_big_integer& b) noexcept {
+    return a ^= b;
+  }
+
+  friend constexpr fixed_big_integer operator<<(fixed_big_integer a, int b) noexcept {
+    return a <<= b;
+  }
+
+  friend constexpr fixed_big_integer operator>>(fixed_big_integer a, int b) noexcept {
+    return a >>= b;
+  }
+
+  friend constexpr bool operator==(const fixed_big_integer& a, const fixed_big_integer& b) noexcept {
+    data_type diff = 0;
+    unroll<LIMBS>([&](auto i) { diff |= a.data_[i] ^ b.data_[i]; });
+    return diff == 0;
+  }
+
+  friend constexpr std::strong_ordering operator<=>(const fixed_big_integer& a, const fixed_big_integer& b) noexcept {
+    if (a.isNegative() != b.isNegative()) {
+      return a.isNegative() ? std::strong_ordering::less : std::strong_ordering::greater;
+    }
+    // with equal signs the two's complement orders like the unsigned limbs
+    for (size_t i = LIMBS; i-- > 0;) {
+      if (a.data_[i] != b.data_[i]) {
+        return a.data_[i] < b.data_[i] ? std::strong_ordering::less : std::strong_ordering::greater;
+      }
+    }
+    return std::strong_ordering::equal;
+  }
+
+  // Same contract as std::to_chars/std::from_chars for base 10. Values out of the range wrap around.
+  friend constexpr std::to_chars_result to_chars(char* first, char* last, const fixed_big_integer& value) {
+    fixed_big_integer magnitude = value.isNegative() ? -value : value;
+    char buf[MAX_CHARS];
+    char* begin = buf + MAX_CHARS;
+    do {
+      data_type chunk = magnitude.divRemSingle(STR_NUMS);
+      for (uint32_t i = 0; i < STR_NUMS_COUNT; ++i) {
+        *--begin = static_cast<char>('0' + chunk % 10);
+        chunk /= 10;
+      }
+    } while (!magnitude.isZero());
+    while (begin + 1 < buf + MAX_CHARS && *begin == '0') {
+      ++begin;
+    }
+    if (value.isNegative()) {
+      *--begin = '-';
+    }
+    size_t size = buf + MAX_CHARS - begin;
+    if (last - first < static_cast<std::ptrdiff_t>(size)) {
+      return {last, std::errc::value_too_large};
+    }
+    return {std::copy(begin, buf + MAX_CHARS, first), std::errc()};
+  }
+
+  friend constexpr std::from_chars_result from_chars(const char* first, const char* last, fixed_big_integer& value) {
+    const char* digits = first;
+    if (digits != last && *digits == '-') {
+      ++digits;
+    }
+    const char* end = digits;
+    while (end != last && *end >= '0' && *end <= '9') {
+      ++end;
+    }
+    if (end == digits) {
+      return {first, std::errc::invalid_argument};
+    }
+    fixed_big_integer res;
+    for (const char* chunk = digits; chunk != end;) {
+      // the first chunk takes the digits above the last multiple of STR_NUMS_COUNT
+      size_t count = (end - chunk) % STR_NUMS_COUNT == 0 ? STR_NUMS_COUNT : (end - chunk) % STR_NUMS_COUNT;
+      data_type factor = 1;
+      data_type word = 0;
+      for (size_t i = 0; i < count; ++i, ++chunk) {
+        factor *= 10;
+        word = word * 10 + (*chunk - '0');
+      }
+      res.mulAddSingle(factor, word);
+    }
+    value = digits != first ? -res : res;
+    return {end, std::errc()};
+  }
+
+  friend std::string to_string(const fixed_big_integer& value) {
+    char buf[MAX_CHARS];
+    return std::string(buf, to_chars(buf, buf + MAX_CHARS, value).ptr);
+  }
+
+  friend std::ostream& operator<<(std::ostream& out, const fixed_big_integer& value) {
+    return out << to_string(value);
+  }
+
+private:
+  constexpr void negate() noexcept {
+    bool carry = true;
+    unroll<LIMBS>([&](auto i) { carry = __builtin_add_overflow(~data_[i], carry, &data_[i]); });
+  }
+
+  // *this = *this * m + carry, modulo 2^Bits
+  constexpr void mulAddSingle(data_type m, data_type carry) noexcept {
+    unroll<LIMBS>([&](auto i) {
+      uint128_t cur = static_cast<uint128_t>(data_[i]) * m + carry;
+      data_[i] = static_cast<data_type>(cur);
+      carry = static_cast<data_type>(cur >> BITS_COUNT);
+    });
+  }
+
+  // divides the unsigned value in place and returns the remainder
+  constexpr data_type divRemSingle(data_type d) noexcept {
+    return big_integer_detail::divRemSingle(data_, LIMBS, d);
+  }
+
+  // number of limbs of the unsigned value without the leading zeroes
+  constexpr size_t significantLimbs() const noexcept {
+    size_t n = LIMBS;
+    while (n > 0 && data_[n - 1] == 0) {
+      --n;
+    }
+    return n;
+  }
+
+  // truncating signed division, Knuth's algorithm D on the magnitudes
+  constexpr void divide(const fixed_big_integer& rhs, fixed_big_integer& quotient, fixed_big_integer& rem) const {
+    bool negative_quotient = isNegative() != rhs.isNegative();
+    bool negative_rem = isNegative();
+    fixed_big_integer u = isNegative() ? -*this : *this;
+    fixed_big_integer v = rhs.isNegative() ? -rhs : rhs;
+    size_t m = u.significantLimbs();
+    size_t n = v.significantLimbs();
+    if (n == 0) {
+      throw std::runtime_error("dividing by zero");
+    }
+    fixed_big_integer q;
+    if (n == 1) {
+      q = u;
+      u = fixed_big_integer(q.divRemSingle(v.data_[0]));
+    } else if (m >= n) {
+      int shift = std::countl_zero(v.data_[n - 1]);
+      data_type un[LIMBS + 1] = {};
+      data_type vn[LIMBS] = {};
+      for (size_t i = n; i-- > 0;) {
+        vn[i] = (v.data_[i] << shift) | (shift != 0 && i > 0 ? v.data_[i - 1] >> (BITS_COUNT - shift) : 0);
+      }
+      un[m] = shift != 0 ? u.data_[m - 1] >> (BITS_COUNT - shift) : 0;
+      for (size_t i = m; i-- > 0;) {
+        un[i] = (u.data_[i] << shift) | (shift != 0 && i > 0 ? u.data_[i - 1] >> (BITS_COUNT - shift) : 0);
+      }
+      big_integer_detail::divKnuth(q.data_, un, m + 1, vn, n);
+      u = fixed_big_integer();
+      for (size_t i = 0; i < n; ++i) {
+        u.data_[i] = (un[i] >> shift) | (shift != 0 ? un[i + 1] << (BITS_COUNT - shift) : 0);
+      }
+    }
+    quotient = negative_quotient ? -q : q;
+    rem = negative_rem ? -u : u;
+  }
+};
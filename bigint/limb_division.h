@@ -0,0 +1,118 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Division kernels on arrays of 64-bit limbs, least significant first, shared by big_integer and
+// fixed_big_integer. Everything is constexpr, so that fixed-width numbers also divide at compile time.
+namespace big_integer_detail {
+
+using limb = uint64_t;
+inline constexpr int LIMB_BITS = std::numeric_limits<limb>::digits;
+
+__extension__ using uint128_t = unsigned __int128;
+
+// r[0, n) += a[0, n), returns the carry out
+constexpr limb addInPlace(limb* r, const limb* a, size_t n) noexcept {
+  limb carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint128_t val = static_cast<uint128_t>(r[i]) + a[i] + carry;
+    r[i] = static_cast<limb>(val);
+    carry = static_cast<limb>(val >> LIMB_BITS);
+  }
+  return carry;
+}
+
+// r[0, n) -= a[0, n) * m, returns the limb to be subtracted from r[n]
+constexpr limb subMul(limb* r, const limb* a, size_t n, limb m) noexcept {
+  limb borrow = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint128_t prod = static_cast<uint128_t>(a[i]) * m + borrow;
+    limb low = static_cast<limb>(prod);
+    borrow = static_cast<limb>(prod >> LIMB_BITS) + (r[i] < low);
+    r[i] -= low;
+  }
+  return borrow;
+}
+
+// Division of a two-limb number by an invariant normalized divisor through its precomputed reciprocal,
+// see Möller, Granlund "Improved division by invariant integers"
+struct limb_divisor {
+  limb d;
+  limb v;
+
+  constexpr explicit limb_divisor(limb d_) noexcept : d(d_), v(static_cast<limb>(~static_cast<uint128_t>(0) / d_)) {}
+
+  // requires high < d
+  constexpr limb divide(limb high, limb low, limb& rem) const noexcept {
+    uint128_t q = static_cast<uint128_t>(v) * high + ((static_cast<uint128_t>(high) << LIMB_BITS) | low);
+    limb q1 = static_cast<limb>(q >> LIMB_BITS) + 1;
+    limb q0 = static_cast<limb>(q);
+    limb r = low - q1 * d;
+    if (r > q0) {
+      --q1;
+      r += d;
+    }
+    if (r >= d) {
+      ++q1;
+      r -= d;
+    }
+    rem = r;
+    return q1;
+  }
+};
+
+// a[0, n) /= d, returns the remainder
+constexpr limb divRemSingle(limb* a, size_t n, limb d) noexcept {
+  if (n == 0) {
+    return 0;
+  }
+  int shift = std::countl_zero(d);
+  limb_divisor divisor(d << shift);
+  limb rem = shift == 0 ? 0 : a[n - 1] >> (LIMB_BITS - shift);
+  for (size_t i = n; i > 0; --i) {
+    limb low = a[i - 1] << shift;
+    if (shift != 0 && i > 1) {
+      low |= a[i - 2] >> (LIMB_BITS - shift);
+    }
+    a[i - 1] = divisor.divide(rem, low, rem);
+  }
+  return rem >> shift;
+}
+
+// Knuth's algorithm D: q[0, un - n) = u / v and u[0, n) = u % v, where v has n >= 2 limbs with the top bit set
+// and u[un - 1] < v[n - 1]; works in place on the windows of u
+constexpr void divKnuth(limb* q, limb* u, size_t un, const limb* v, size_t n) noexcept {
+  limb_divisor top(v[n - 1]);
+  for (size_t j = un - n; j-- > 0;) {
+    limb* window = u + j;
+    limb q_hat = 0;
+    limb r_hat = 0;
+    bool r_overflow = false;
+    if (window[n] >= v[n - 1]) {
+      q_hat = ~limb(0);
+      r_hat = window[n - 1] + v[n - 1];
+      r_overflow = r_hat < v[n - 1];
+    } else {
+      q_hat = top.divide(window[n], window[n - 1], r_hat);
+    }
+    while (!r_overflow &&
+           static_cast<uint128_t>(q_hat) * v[n - 2] > ((static_cast<uint128_t>(r_hat) << LIMB_BITS) | window[n - 2])) {
+      --q_hat;
+      r_hat += v[n - 1];
+      r_overflow = r_hat < v[n - 1];
+    }
+    limb borrow = subMul(window, v, n, q_hat);
+    bool negative = window[n] < borrow;
+    window[n] -= borrow;
+    if (negative) {
+      --q_hat;
+      window[n] += addInPlace(window, v, n);
+    }
+    q[j] = q_hat;
+  }
+}
+
+} // namespace big_integer_detail
@@ -0,0 +1,57 @@
+#include "bench_utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+namespace {
+volatile bool sink;
+volatile int one = 1;
+
+// GB/s of a += b, a -= b, a *= x and a == b against the std::transform and operator() loops used before
+template <typename T>
+void run(const char* type) {
+  const size_t sizes[] = {64, 256, 1024, 4096};
+  for (size_t n : sizes) {
+    matrix<T> a = random_matrix<T>(n, n);
+    matrix<T> b = random_matrix<T>(n, n);
+    matrix<T> c = b;
+    // Read through a volatile so that the compiler can't drop a multiplication by one
+    T factor = static_cast<T>(one);
+    double bytes = static_cast<double>(a.size() * sizeof(T));
+
+    double add_plain = measure([&] { std::transform(a.begin(), a.end(), b.begin(), a.begin(), std::plus<>{}); });
+    double add = measure([&] { a += b; });
+    double scale_plain =
+        measure([&] { std::transform(a.begin(), a.end(), a.begin(), [&](T x) { return x * factor; }); });
+    double scale = measure([&] { a *= factor; });
+    double equal_plain = measure([&] {
+      bool equal = true;
+      for (size_t i = 0; i < b.rows() && equal; ++i) {
+        for (size_t j = 0; j < b.cols(); ++j) {
+          if (b(i, j) != c(i, j)) {
+            equal = false;
+            break;
+          }
+        }
+      }
+      sink = equal;
+    });
+    double equal = measure([&] { sink = b == c; });
+
+    std::printf("%-8s %6zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", type, n, 3 * bytes / add_plain / 1e3,
+                3 * bytes / add / 1e3, 2 * bytes / scale_plain / 1e3, 2 * bytes / scale / 1e3,
+                2 * bytes / equal_plain / 1e3, 2 * bytes / equal / 1e3);
+  }
+}
+} // namespace
+
+// Columns are memory traffic in GB/s, a += b counts two loads and a store per element
+int main() {
+  std::printf("%-8s %6s %10s %10s %10s %10s %10s %10s\n", "type", "n", "add plain", "a += b", "mul plain", "a *= x",
+              "eq plain", "a == b");
+  run<float>("float");
+  run<double>("double");
+  run<int32_t>("int32");
+  run<int64_t>("int64");
+}
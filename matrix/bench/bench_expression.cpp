@@ -0,0 +1,44 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+
+namespace {
+// a + b + c * 2 the way operator+ and operator* used to evaluate it, with a temporary per operation
+template <typename T>
+matrix<T> eager_sum(const matrix<T>& a, const matrix<T>& b, const matrix<T>& c) {
+  matrix<T> ab = a;
+  ab += b;
+  matrix<T> c2 = c;
+  c2 *= T(2);
+  matrix<T> out = ab;
+  out += c2;
+  return out;
+}
+
+template <typename T>
+matrix<T> eager_gemm(const matrix<T>& a, const matrix<T>& b, const matrix<T>& c) {
+  matrix<T> ab = a;
+  ab *= b;
+  matrix<T> out = ab;
+  out += c;
+  return out;
+}
+} // namespace
+
+// Microseconds of a + b + c * 2 and a * b + c with a temporary per operation and as a single expression
+int main() {
+  std::printf("%-8s %6s %12s %12s %8s %12s %12s %8s\n", "type", "n", "sum eager", "sum fused", "speedup",
+              "gemm eager", "gemm fused", "speedup");
+  const size_t sizes[] = {64, 256, 1024, 2048};
+  for (size_t n : sizes) {
+    matrix<double> a = random_matrix<double>(n, n);
+    matrix<double> b = random_matrix<double>(n, n);
+    matrix<double> c = random_matrix<double>(n, n);
+    double sum_eager = measure([&] { matrix<double> out = eager_sum(a, b, c); });
+    double sum_fused = measure([&] { matrix<double> out = a + b + c * 2.0; });
+    double gemm_eager = measure([&] { matrix<double> out = eager_gemm(a, b, c); });
+    double gemm_fused = measure([&] { matrix<double> out = a * b + c; });
+    std::printf("%-8s %6zu %12.1f %12.1f %8.2f %12.1f %12.1f %8.2f\n", "double", n, sum_eager, sum_fused,
+                sum_eager / sum_fused, gemm_eager, gemm_fused, gemm_eager / gemm_fused);
+  }
+}
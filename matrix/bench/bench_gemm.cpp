@@ -0,0 +1,42 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+
+namespace {
+// The i-j-k loop operator*= used before blocking, kept as the baseline
+template <typename T>
+matrix<T> multiply_naive(const matrix<T>& a, const matrix<T>& b) {
+  matrix<T> out(a.rows(), b.cols());
+  for (size_t i = 0; i < a.rows(); ++i) {
+    for (size_t j = 0; j < b.cols(); ++j) {
+      for (size_t k = 0; k < a.cols(); ++k) {
+        out(i, j) += a(i, k) * b(k, j);
+      }
+    }
+  }
+  return out;
+}
+
+template <typename T>
+void run(const char* type) {
+  const size_t sizes[] = {16, 64, 127, 256, 512, 1024};
+  for (size_t n : sizes) {
+    matrix<T> a = random_matrix<T>(n, n);
+    matrix<T> b = random_matrix<T>(n, n);
+    double flops = 2.0 * n * n * n;
+    double naive = n <= 512 ? measure([&] { matrix<T> c = multiply_naive(a, b); }) : 0;
+    double blocked = measure([&] { matrix<T> c = a * b; });
+    std::printf("%-8s %6zu %12.3f %12.3f %10.2f\n", type, n, naive == 0 ? 0 : flops / naive / 1e3,
+                flops / blocked / 1e3, naive == 0 ? 0 : naive / blocked);
+  }
+}
+} // namespace
+
+// GFLOP/s of the square matrix product for the naive loop and operator*, the naive loop is skipped above 512
+int main() {
+  std::printf("%-8s %6s %12s %12s %10s\n", "type", "n", "naive", "operator*", "speedup");
+  run<float>("float");
+  run<double>("double");
+  run<int>("int");
+  run<long long>("int64");
+}
@@ -0,0 +1,37 @@
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// GFLOP/s of multiply(a, b, threads, tile) and GB/s of a += b for 1 to all cores (or argv[1]) threads, with the
+// speedup over a single thread; argv[2] sets the tile size
+int main(int argc, char* argv[]) {
+  size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+  size_t tile = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : matrix_parallel::tile_size;
+  const size_t sizes[] = {512, 1024, 2048};
+
+  std::printf("%-8s %6s %10s %10s %10s %10s\n", "threads", "n", "GFLOP/s", "speedup", "add GB/s", "speedup");
+  for (size_t n : sizes) {
+    matrix<double> a = random_matrix<double>(n, n);
+    matrix<double> b = random_matrix<double>(n, n);
+    matrix<double> c = random_matrix<double>(2 * n, 2 * n);
+    matrix<double> d = random_matrix<double>(2 * n, 2 * n);
+    double flops = 2.0 * n * n * n;
+    double bytes = 3.0 * c.size() * sizeof(double);
+    double base_mul = 0;
+    double base_add = 0;
+    for (size_t threads = 1; threads <= std::max<size_t>(max_threads, 1); ++threads) {
+      double mul = measure([&] { matrix<double> out = multiply(a, b, threads, tile); });
+      matrix_parallel::thread_count = threads;
+      matrix_parallel::elementwise_threshold = 0;
+      double add = measure([&] { c += d; });
+      if (threads == 1) {
+        base_mul = mul;
+        base_add = add;
+      }
+      std::printf("%-8zu %6zu %10.2f %10.2f %10.2f %10.2f\n", threads, n, flops / mul / 1e3, base_mul / mul,
+                  bytes / add / 1e3, base_add / add);
+    }
+  }
+}
@@ -0,0 +1,45 @@
+#include "bench_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+// Largest difference from the classical product relative to the largest element of it
+double relative_error(const matrix<double>& result, const matrix<double>& reference) {
+  double error = 0;
+  double scale = 0;
+  for (size_t i = 0; i < reference.size(); ++i) {
+    error = std::max(error, std::abs(result.data()[i] - reference.data()[i]));
+    scale = std::max(scale, std::abs(reference.data()[i]));
+  }
+  return error / scale;
+}
+} // namespace
+
+// Milliseconds of the single-threaded classical product and of multiply_strassen with a few thresholds for square
+// double matrices up to argv[1] (4096 by default), with the relative error of the Strassen results
+int main(int argc, char* argv[]) {
+  size_t max_size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+  const size_t thresholds[] = {128, 256, 512};
+  matrix_parallel::thread_count = 1;
+
+  std::printf("%6s %12s", "n", "classical");
+  for (size_t threshold : thresholds) {
+    std::printf(" %9s%-3zu %9s", "strassen/", threshold, "error");
+  }
+  std::printf("\n");
+  for (size_t n = 256; n <= max_size; n *= 2) {
+    matrix<double> a = random_matrix<double>(n, n);
+    matrix<double> b = random_matrix<double>(n, n);
+    matrix<double> reference = a * b;
+    std::printf("%6zu %12.1f", n, measure([&] { matrix<double> c = a * b; }) / 1e3);
+    for (size_t threshold : thresholds) {
+      matrix<double> c = multiply_strassen(a, b, threshold);
+      double time = measure([&] { c = multiply_strassen(a, b, threshold); });
+      std::printf(" %12.1f %9.1e", time / 1e3, relative_error(c, reference));
+    }
+    std::printf("\n");
+  }
+}
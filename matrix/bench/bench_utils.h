@@ -0,0 +1,38 @@
+#pragma once
+
+#include "matrix.h"
+
+#include <chrono>
+#include <random>
+#include <type_traits>
+
+template <typename T>
+matrix<T> random_matrix(size_t rows, size_t cols) {
+  static std::mt19937 rng(42);
+  matrix<T> out(rows, cols);
+  for (T& x : out) {
+    if constexpr (std::is_floating_point_v<T>) {
+      x = std::uniform_real_distribution<T>(-1, 1)(rng);
+    } else {
+      x = static_cast<T>(std::uniform_int_distribution<int>(-100, 100)(rng));
+    }
+  }
+  return out;
+}
+
+// Average time of a single call of f in microseconds, repeated until the total exceeds 20ms
+template <typename F>
+double measure(F f) {
+  size_t iterations = 1;
+  while (true) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      f();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() > 20'000) {
+      return elapsed.count() / iterations;
+    }
+    iterations *= 2;
+  }
+}
@@ -0,0 +1,112 @@
+#include "check_utils.h"
+
+#include <string>
+
+namespace {
+// Element-wise operators and expressions against loops over the elements, for sizes around the vector widths
+template <typename T>
+void check_elementwise(const char* type) {
+  for (size_t rows : {0, 1, 3, 8, 33}) {
+    for (size_t cols : {1, 5, 16, 65}) {
+      if (rows == 0 && cols != 1) {
+        continue;
+      }
+      matrix<T> a = random_matrix<T>(rows, cols);
+      matrix<T> b = random_matrix<T>(rows, cols);
+      matrix<T> c = random_matrix<T>(rows, cols);
+      T x = T(3);
+      std::string what = std::string(type) + " " + std::to_string(rows) + " x " + std::to_string(cols);
+      auto at = [](const matrix<T>& m, size_t i, size_t j) { return m.empty() ? T(0) : m(i, j); };
+
+      matrix<T> sum = naive_map<T>(rows, cols, [&](size_t i, size_t j) { return at(a, i, j) + at(b, i, j); });
+      matrix<T> difference = naive_map<T>(rows, cols, [&](size_t i, size_t j) { return at(a, i, j) - at(b, i, j); });
+      matrix<T> scaled = naive_map<T>(rows, cols, [&](size_t i, size_t j) { return at(a, i, j) * x; });
+      matrix<T> mixed = naive_map<T>(
+          rows, cols, [&](size_t i, size_t j) { return (at(a, i, j) + at(b, i, j)) * x - at(c, i, j); });
+
+      expect(matrix<T>(a + b) == sum, "a + b for " + what);
+      expect(matrix<T>(a - b) == difference, "a - b for " + what);
+      expect(matrix<T>(a * x) == scaled && matrix<T>(x * a) == scaled, "a * x for " + what);
+      expect(matrix<T>((a + b) * x - c) == mixed, "(a + b) * x - c for " + what);
+      // the tree owns the temporary operand
+      auto kept = (matrix<T>(a) + b) * x - c;
+      expect(matrix<T>(kept) == mixed, "a tree kept in an auto variable for " + what);
+
+      matrix<T> d = a;
+      d += b;
+      expect(d == sum, "a += b for " + what);
+      d = a;
+      d -= b;
+      expect(d == difference, "a -= b for " + what);
+      d = a;
+      d *= x;
+      expect(d == scaled, "a *= x for " + what);
+      d = c;
+      d = (a + b) * x - c;
+      expect(d == mixed, "assignment of an expression for " + what);
+      expect(!(cols > 1 && rows > 0 && sum == difference && b != matrix<T>(rows, cols)), "== for " + what);
+    }
+  }
+}
+
+// Expressions that read the matrix they are assigned to
+template <typename T>
+void check_aliasing(const char* type) {
+  for (size_t n : {1, 4, 17, 40}) {
+    const matrix<T> a0 = random_matrix<T>(n, n);
+    const matrix<T> b = random_matrix<T>(n, n);
+    const matrix<T> square = naive_product(a0, a0);
+    std::string what = std::string(type) + " " + std::to_string(n) + " x " + std::to_string(n);
+
+    matrix<T> a = a0;
+    a = a * a + a;
+    expect(a == naive_map<T>(n, n, [&](size_t i, size_t j) { return square(i, j) + a0(i, j); }),
+           "a = a * a + a for " + what);
+    a = a0;
+    a += a * a;
+    expect(a == naive_map<T>(n, n, [&](size_t i, size_t j) { return a0(i, j) + square(i, j); }),
+           "a += a * a for " + what);
+    a = a0;
+    a = b - a * T(2);
+    expect(a == naive_map<T>(n, n, [&](size_t i, size_t j) { return b(i, j) - a0(i, j) * T(2); }),
+           "a = b - a * 2 for " + what);
+    a = a0;
+    a -= a * b;
+    matrix<T> product = naive_product(a0, b);
+    expect(a == naive_map<T>(n, n, [&](size_t i, size_t j) { return a0(i, j) - product(i, j); }),
+           "a -= a * b for " + what);
+    a = a0;
+    a *= a;
+    expect(a == square, "a *= a for " + what);
+    a = a0;
+    a = a + a;
+    expect(a == naive_map<T>(n, n, [&](size_t i, size_t j) { return a0(i, j) + a0(i, j); }), "a = a + a for " + what);
+  }
+}
+
+template <typename T>
+void check_all(const char* type) {
+  check_elementwise<T>(type);
+  check_aliasing<T>(type);
+}
+
+void check_types() {
+  check_all<int32_t>("int32");
+  check_all<int64_t>("int64");
+  check_all<float>("float");
+  check_all<double>("double");
+  check_all<boxed>("boxed");
+}
+} // namespace
+
+int main() {
+  check_types();
+
+  // every element-wise pass and product split over the pools, down to empty matrices
+  matrix_parallel::thread_count = 4;
+  matrix_parallel::elementwise_threshold = 0;
+  matrix_parallel::multiply_threshold = 1;
+  matrix_parallel::tile_size = 8;
+  check_types();
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include "check_utils.h"
+
+#include <string>
+
+namespace {
+constexpr size_t SIZES[] = {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 65, 129, 257};
+
+size_t random_size() {
+  return SIZES[rng()() % std::size(SIZES)];
+}
+
+// Every way to multiply against the triple loop. Elements are small integers, so the sums are exact for
+// floating-point T as well, whatever order the kernels add them in
+template <typename T>
+void check_products(const char* type, size_t count, size_t max_size) {
+  for (size_t i = 0; i < count; ++i) {
+    size_t m = random_size();
+    size_t k = random_size();
+    size_t n = random_size();
+    if (std::max({m, k, n}) > max_size) {
+      continue;
+    }
+    matrix<T> a = random_matrix<T>(m, k);
+    matrix<T> b = random_matrix<T>(k, n);
+    matrix<T> expected = naive_product(a, b);
+    std::string what = std::string(type) + " " + dims(m, k, n);
+
+    matrix_parallel::multiply_threshold = size_t(1) << 21;
+    expect(matrix<T>(a * b) == expected, "a * b for " + what);
+    matrix_parallel::multiply_threshold = 1;
+    expect(matrix<T>(a * b) == expected, "a * b on the tile pool for " + what);
+
+    size_t threads = 1 + rng()() % 4;
+    size_t tile = 1 + rng()() % 70;
+    expect(multiply(a, b, threads, tile) == expected,
+           "multiply with " + std::to_string(threads) + " threads and tile " + std::to_string(tile) + " for " + what);
+
+    // thresholds below the sizes, so that the operands are padded and split down to a few elements
+    for (size_t threshold : {1, 3, 8}) {
+      expect(multiply_strassen(a, b, threshold) == expected,
+             "multiply_strassen with threshold " + std::to_string(threshold) + " for " + what);
+    }
+
+    if (m == k) {
+      matrix<T> c = a;
+      c *= b;
+      expect(c == expected, "a *= b for " + what);
+    }
+  }
+}
+} // namespace
+
+int main() {
+  matrix_parallel::thread_count = 4;
+  matrix_parallel::tile_size = 16;
+
+  check_products<int32_t>("int32", 150, 257);
+  check_products<int64_t>("int64", 150, 257);
+  check_products<float>("float", 150, 257);
+  check_products<double>("double", 150, 257);
+  check_products<boxed>("boxed", 60, 65);
+
+  expect(matrix<int>(matrix<int>(0, 3) * matrix<int>(3, 5)).empty(), "a product with no rows is not empty");
+  expect(matrix<int>(matrix<int>(4, 0) * matrix<int>(0, 2)).empty(), "a product with no inner dimension is not empty");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "matrix.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <type_traits>
+
+inline size_t failures = 0;
+
+// Reports a failed condition, the program exits with failures != 0
+inline void expect(bool condition, const std::string& what) {
+  if (!condition) {
+    ++failures;
+    std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+  }
+}
+
+inline std::mt19937_64& rng() {
+  static std::mt19937_64 engine(42);
+  return engine;
+}
+
+// Elements in [-100, 100], small enough that integer products of a few hundred terms are exact
+template <typename T>
+matrix<T> random_matrix(size_t rows, size_t cols) {
+  matrix<T> out(rows, cols);
+  for (T& x : out) {
+    x = T(static_cast<int>(rng()() % 201) - 100);
+  }
+  return out;
+}
+
+inline std::string dims(size_t rows, size_t inner, size_t cols) {
+  return std::to_string(rows) + " x " + std::to_string(inner) + " x " + std::to_string(cols);
+}
+
+// The textbook triple loop, the reference for every product
+template <typename T>
+matrix<T> naive_product(const matrix<T>& left, const matrix<T>& right) {
+  matrix<T> out(left.rows(), right.cols());
+  for (size_t i = 0; i < left.rows(); ++i) {
+    for (size_t j = 0; j < right.cols(); ++j) {
+      T sum = T(0);
+      for (size_t k = 0; k < left.cols(); ++k) {
+        sum = sum + left(i, k) * right(k, j);
+      }
+      out(i, j) = sum;
+    }
+  }
+  return out;
+}
+
+// out(i, j) = f(i, j) for every element
+template <typename T, typename F>
+matrix<T> naive_map(size_t rows, size_t cols, F f) {
+  matrix<T> out(rows, cols);
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < cols; ++j) {
+      out(i, j) = f(i, j);
+    }
+  }
+  return out;
+}
+
+// A number type that is not arithmetic, so every operation takes the generic path
+struct boxed {
+  int64_t value = 0;
+
+  boxed() = default;
+
+  explicit boxed(int64_t v) : value(v) {}
+
+  friend boxed operator+(const boxed& a, const boxed& b) {
+    return boxed(a.value + b.value);
+  }
+
+  friend boxed operator-(const boxed& a, const boxed& b) {
+    return boxed(a.value - b.value);
+  }
+
+  friend boxed operator*(const boxed& a, const boxed& b) {
+    return boxed(a.value * b.value);
+  }
+
+  boxed& operator+=(const boxed& b) {
+    value += b.value;
+    return *this;
+  }
+
+  boxed& operator-=(const boxed& b) {
+    value -= b.value;
+    return *this;
+  }
+
+  boxed& operator*=(const boxed& b) {
+    value *= b.value;
+    return *this;
+  }
+
+  friend bool operator==(const boxed& a, const boxed& b) {
+    return a.value == b.value;
+  }
+
+  friend bool operator!=(const boxed& a, const boxed& b) {
+    return a.value != b.value;
+  }
+};
+
+static_assert(!std::is_arithmetic_v<boxed>);
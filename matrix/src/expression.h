@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+template <class T>
+class matrix;
+
+// Lazy matrix arithmetic. a + b, a - b, a * x and x * a build a tree of nodes that refers to its matrix operands, and
+// the tree is evaluated when it becomes a matrix (construction, assignment, += and -=), in a single pass over the
+// result. a * b is a node as well: on its own, added to an expression or passed to += it is computed by the matrix
+// multiplication kernel accumulating straight into the result; inside any other expression it is computed once
+// before the pass. Temporary matrices are moved into the tree, so a tree can be kept in an auto variable as long as
+// the named matrices it refers to are alive
+namespace matrix_expr {
+
+template <typename E>
+struct expression {
+  const E& self() const {
+    return static_cast<const E&>(*this);
+  }
+
+  auto operator()(size_t row, size_t col) const {
+    self().prepare();
+    return self()[row * self().cols() + col];
+  }
+};
+
+template <typename E>
+inline constexpr bool is_matrix = false;
+
+template <typename T>
+inline constexpr bool is_matrix<matrix<T>> = true;
+
+template <typename E>
+concept node = std::is_base_of_v<expression<std::remove_cvref_t<E>>, std::remove_cvref_t<E>>;
+
+template <typename E>
+concept operand = node<E> || is_matrix<std::remove_cvref_t<E>>;
+
+// A matrix inside a tree, M is a const reference to a named matrix or a matrix moved out of a temporary
+template <typename M>
+class terminal : public expression<terminal<M>> {
+public:
+  using value_type = typename std::remove_cvref_t<M>::value_type;
+
+  explicit terminal(M m) : m_(std::forward<M>(m)) {}
+
+  size_t rows() const {
+    return m_.rows();
+  }
+
+  size_t cols() const {
+    return m_.cols();
+  }
+
+  value_type operator[](size_t i) const {
+    return m_.data()[i];
+  }
+
+  void prepare() const {}
+
+private:
+  M m_;
+};
+
+// Nodes are stored in their parents by value, matrices as terminals that refer to lvalues and own rvalues
+template <typename E>
+auto wrap(E&& e) {
+  using type = std::remove_cvref_t<E>;
+  if constexpr (is_matrix<type> && std::is_lvalue_reference_v<E>) {
+    return terminal<const type&>(e);
+  } else if constexpr (is_matrix<type>) {
+    return terminal<type>(std::move(e));
+  } else {
+    return type(std::forward<E>(e));
+  }
+}
+
+template <typename E>
+using wrapped = decltype(wrap(std::declval<E>()));
+
+// left[i] + right[i] or left[i] - right[i]
+template <typename Op, typename L, typename R>
+class binary : public expression<binary<Op, L, R>> {
+public:
+  using value_type = typename L::value_type;
+
+  binary(L left, R right) : left_(std::move(left)), right_(std::move(right)) {}
+
+  size_t rows() const {
+    return left_.rows();
+  }
+
+  size_t cols() const {
+    return left_.cols();
+  }
+
+  value_type operator[](size_t i) const {
+    return Op{}(left_[i], right_[i]);
+  }
+
+  void prepare() const {
+    left_.prepare();
+    right_.prepare();
+  }
+
+  const L& left() const {
+    return left_;
+  }
+
+  const R& right() const {
+    return right_;
+  }
+
+private:
+  L left_;
+  R right_;
+};
+
+// e[i] * factor
+template <typename E>
+class scaled : public expression<scaled<E>> {
+public:
+  using value_type = typename E::value_type;
+
+  scaled(E e, const value_type& factor) : e_(std::move(e)), factor_(factor) {}
+
+  size_t rows() const {
+    return e_.rows();
+  }
+
+  size_t cols() const {
+    return e_.cols();
+  }
+
+  value_type operator[](size_t i) const {
+    return e_[i] * factor_;
+  }
+
+  void prepare() const {
+    e_.prepare();
+  }
+
+private:
+  E e_;
+  value_type factor_;
+};
+
+// Matrix product of two matrices, L and R are either const references or matrices that are owned by the node. The
+// matrix constructor and += use left() and right() directly, element access goes through a result computed once by
+// prepare
+template <typename L, typename R>
+class product : public expression<product<L, R>> {
+public:
+  using matrix_type = std::remove_cvref_t<L>;
+  using value_type = typename matrix_type::value_type;
+
+  product(L left, R right) : left_(std::forward<L>(left)), right_(std::forward<R>(right)) {}
+
+  size_t rows() const {
+    return left_.rows();
+  }
+
+  size_t cols() const {
+    return right_.cols();
+  }
+
+  value_type operator[](size_t i) const {
+    return result_.data()[i];
+  }
+
+  void prepare() const {
+    if (!prepared_) {
+      result_ = matrix_type(*this);
+      prepared_ = true;
+    }
+  }
+
+  const matrix_type& left() const {
+    return left_;
+  }
+
+  const matrix_type& right() const {
+    return right_;
+  }
+
+private:
+  L left_;
+  R right_;
+  mutable matrix_type result_;
+  mutable bool prepared_ = false;
+};
+
+template <typename E>
+inline constexpr bool is_product = false;
+
+template <typename L, typename R>
+inline constexpr bool is_product<product<L, R>> = true;
+
+// A * B + C or C + A * B, evaluated as C followed by the product accumulated into it
+template <typename E>
+inline constexpr bool is_product_sum = false;
+
+template <typename L, typename R>
+inline constexpr bool is_product_sum<binary<std::plus<>, L, R>> = is_product<L> || is_product<R>;
+
+// A product operand: named matrices are referenced, temporaries are moved and anything else is evaluated into a
+// matrix of its own
+template <typename E>
+decltype(auto) product_operand(E&& e) {
+  using type = std::remove_cvref_t<E>;
+  if constexpr (is_matrix<type> && std::is_lvalue_reference_v<E>) {
+    return static_cast<const type&>(e);
+  } else if constexpr (is_matrix<type>) {
+    return type(std::move(e));
+  } else {
+    return matrix<typename type::value_type>(e);
+  }
+}
+
+template <typename L, typename R>
+auto make_product(L&& left, R&& right) {
+  using left_type = decltype(product_operand(std::forward<L>(left)));
+  using right_type = decltype(product_operand(std::forward<R>(right)));
+  return product<left_type, right_type>(product_operand(std::forward<L>(left)),
+                                        product_operand(std::forward<R>(right)));
+}
+
+template <typename Op, typename L, typename R>
+auto make_binary(L&& left, R&& right) {
+  return binary<Op, wrapped<L>, wrapped<R>>(wrap(std::forward<L>(left)), wrap(std::forward<R>(right)));
+}
+
+template <typename E>
+auto make_scaled(E&& e, const typename std::remove_cvref_t<E>::value_type& factor) {
+  return scaled<wrapped<E>>(wrap(std::forward<E>(e)), factor);
+}
+
+// The operators of two matrices or of a matrix and a scalar are hidden friends of matrix, these take over as soon as
+// one operand is a node
+
+template <operand L, operand R>
+  requires(node<L> || node<R>)
+auto operator+(L&& left, R&& right) {
+  return make_binary<std::plus<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <operand L, operand R>
+  requires(node<L> || node<R>)
+auto operator-(L&& left, R&& right) {
+  return make_binary<std::minus<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <operand L, operand R>
+  requires(node<L> || node<R>)
+auto operator*(L&& left, R&& right) {
+  return make_product(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <node E>
+auto operator*(E&& e, const typename std::remove_cvref_t<E>::value_type& factor) {
+  return make_scaled(std::forward<E>(e), factor);
+}
+
+template <node E>
+auto operator*(const typename std::remove_cvref_t<E>::value_type& factor, E&& e) {
+  return make_scaled(std::forward<E>(e), factor);
+}
+
+} // namespace matrix_expr
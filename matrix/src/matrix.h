@@ -1,8 +1,17 @@
 #pragma once
 
+#include "expression.h"
+#include "parallel.h"
+#include "simd.h"
+
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 template <class T>
 class matrix {
@@ -129,6 +138,10 @@ private:
   size_t rows_;
   size_t cols_;
 
+  // Operands of the arithmetic operators: any reference to this matrix type
+  template <typename M>
+  static constexpr bool is_self = std::is_same_v<std::remove_cvref_t<M>, matrix>;
+
 public:
   using value_type = T;
 
@@ -150,26 +163,75 @@ public:
 public:
   matrix() : data_(nullptr), rows_(0), cols_(0) {}
 
-  matrix(size_t rows, size_t cols)
-      : data_(rows * cols == 0 ? nullptr : new T[rows * cols]()),
-        rows_(rows * cols == 0 ? 0 : rows),
-        cols_(rows * cols == 0 ? 0 : cols) {}
+  matrix(size_t rows, size_t cols) : matrix() {
+    if (rows * cols != 0) {
+      storage_guard storage(rows * cols);
+      std::uninitialized_value_construct_n(storage.data, rows * cols);
+      adopt(storage, rows, cols);
+    }
+  }
 
   template <size_t Rows, size_t Cols>
-  matrix(const T (&init)[Rows][Cols]) : data_(new T[Rows * Cols]),
-                                        rows_(Rows),
-                                        cols_(Cols) {
-    iterator it = begin();
-    for (size_t i = 0; i < rows(); i++) {
-      it = std::copy_n(init[i], cols_, it);
+  matrix(const T (&init)[Rows][Cols]) : matrix() {
+    storage_guard storage(Rows * Cols);
+    for (size_t i = 0; i < Rows; i++) {
+      std::uninitialized_copy_n(init[i], Cols, storage.data + storage.constructed);
+      storage.constructed += Cols;
     }
+    adopt(storage, Rows, Cols);
   }
 
-  matrix(const matrix& other)
-      : data_(other.size() == 0 ? nullptr : new T[other.size()]),
-        rows_(other.size() == 0 ? 0 : other.rows()),
-        cols_(other.size() == 0 ? 0 : other.cols()) {
-    std::copy(other.begin(), other.end(), begin());
+  matrix(const matrix& other) : matrix() {
+    if (!other.empty()) {
+      storage_guard storage(other.size());
+      std::uninitialized_copy(other.begin(), other.end(), storage.data);
+      adopt(storage, other.rows(), other.cols());
+    }
+  }
+
+  matrix(matrix&& other) noexcept : data_(other.data_), rows_(other.rows_), cols_(other.cols_) {
+    other.data_ = nullptr;
+    other.rows_ = 0;
+    other.cols_ = 0;
+  }
+
+  // Evaluates an expression of matrix_expr in a single pass, see expression.h
+  template <typename E>
+  matrix(const matrix_expr::expression<E>& expr) : matrix() {
+    const E& e = expr.self();
+    if constexpr (matrix_expr::is_product<E>) {
+      matrix out(e.rows(), e.cols());
+      multiply_add(e.left(), e.right(), out);
+      swap(out);
+    } else if constexpr (matrix_expr::is_product_sum<E>) {
+      if constexpr (matrix_expr::is_product<std::remove_cvref_t<decltype(e.left())>>) {
+        matrix out(e.right());
+        multiply_add(e.left().left(), e.left().right(), out);
+        swap(out);
+      } else {
+        matrix out(e.left());
+        multiply_add(e.right().left(), e.right().right(), out);
+        swap(out);
+      }
+    } else if (e.rows() * e.cols() != 0) {
+      e.prepare();
+      size_t count = e.rows() * e.cols();
+      storage_guard storage(count);
+      if constexpr (std::is_arithmetic_v<T>) {
+        // nothing throws, so the chunks can be constructed in any order
+        matrix_parallel::for_each_chunk(count, [&](size_t first, size_t last) {
+          for (size_t i = first; i < last; ++i) {
+            std::construct_at(storage.data + i, e[i]);
+          }
+        });
+      } else {
+        // one by one, so that the guard knows which elements to destroy if one of them throws
+        for (; storage.constructed < count; ++storage.constructed) {
+          std::construct_at(storage.data + storage.constructed, e[storage.constructed]);
+        }
+      }
+      adopt(storage, e.rows(), e.cols());
+    }
   }
 
   matrix& operator=(const matrix& other) {
@@ -180,6 +242,31 @@ public:
     return *this;
   }
 
+  matrix& operator=(matrix&& other) noexcept {
+    matrix(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  // Element-wise expressions of the same size are evaluated in place: every element of the result only depends on
+  // the elements of the operands at the same position, and products inside them are computed before the pass
+  template <typename E>
+  matrix& operator=(const matrix_expr::expression<E>& expr) {
+    const E& e = expr.self();
+    if constexpr (!matrix_expr::is_product<E> && !matrix_expr::is_product_sum<E>) {
+      if (!empty() && e.rows() == rows() && e.cols() == cols()) {
+        e.prepare();
+        matrix_parallel::for_each_chunk(size(), [&](size_t first, size_t last) {
+          for (size_t i = first; i < last; ++i) {
+            data_[i] = e[i];
+          }
+        });
+        return *this;
+      }
+    }
+    matrix(expr).swap(*this);
+    return *this;
+  }
+
   void swap(matrix& other) {
     std::swap(data_, other.data_);
     std::swap(rows_, other.rows_);
@@ -187,7 +274,8 @@ public:
   }
 
   ~matrix() {
-    delete[] data_;
+    std::destroy_n(data_, size());
+    deallocate(data_);
   }
 
   // Iterators
@@ -282,14 +370,22 @@ public:
     if (left.cols() != right.cols() || left.rows() != right.rows()) {
       return false;
     }
-    for (size_t i = 0; i < left.rows(); ++i) {
-      for (size_t j = 0; j < left.cols(); ++j) {
-        if (left(i, j) != right(i, j)) {
-          return false;
-        }
+    std::atomic<bool> equal = true;
+    matrix_parallel::for_each_chunk(left.size(), [&](size_t first, size_t last) {
+      if (!equal.load(std::memory_order_relaxed)) {
+        return;
       }
-    }
-    return true;
+      bool chunk_equal;
+      if constexpr (matrix_simd::supported<T>) {
+        chunk_equal = matrix_simd::equal(left.data() + first, right.data() + first, last - first);
+      } else {
+        chunk_equal = std::equal(left.begin() + first, left.begin() + last, right.begin() + first);
+      }
+      if (!chunk_equal) {
+        equal.store(false, std::memory_order_relaxed);
+      }
+    });
+    return equal.load(std::memory_order_relaxed);
   }
 
   friend bool operator!=(const matrix& left, const matrix& right) {
@@ -299,59 +395,417 @@ public:
   // Arithmetic operations
 
   matrix& operator+=(const matrix& other) {
-    std::transform(begin(), end(), other.begin(), begin(), std::plus<>{});
+    matrix_parallel::for_each_chunk(size(), [&](size_t first, size_t last) {
+      if constexpr (matrix_simd::supported<T>) {
+        matrix_simd::combine<matrix_simd::op::add>(data() + first, other.data() + first, last - first);
+      } else {
+        std::transform(begin() + first, begin() + last, other.begin() + first, begin() + first, std::plus<>{});
+      }
+    });
     return *this;
   }
 
   matrix& operator-=(const matrix& other) {
-    std::transform(begin(), end(), other.begin(), begin(), std::minus<>{});
+    matrix_parallel::for_each_chunk(size(), [&](size_t first, size_t last) {
+      if constexpr (matrix_simd::supported<T>) {
+        matrix_simd::combine<matrix_simd::op::sub>(data() + first, other.data() + first, last - first);
+      } else {
+        std::transform(begin() + first, begin() + last, other.begin() + first, begin() + first, std::minus<>{});
+      }
+    });
     return *this;
   }
 
   matrix& operator*=(const matrix& other) {
     matrix<value_type> out(rows(), other.cols());
-    for (size_t i = 0; i < rows(); ++i) {
-      for (size_t j = 0; j < other.cols(); ++j) {
-        out(i, j) = 0;
-        for (size_t k = 0; k < cols(); ++k) {
-          out(i, j) += (*this)(i, k) * other(k, j);
-        }
-      }
-    }
-    *this = out;
+    multiply_add(*this, other, out);
+    swap(out);
     return *this;
   }
 
   matrix& operator*=(const_reference factor) {
-    std::transform(begin(), end(), begin(), [&factor](T a) { return a * factor; });
+    value_type value = factor;
+    matrix_parallel::for_each_chunk(size(), [&](size_t first, size_t last) {
+      if constexpr (matrix_simd::supported<T>) {
+        matrix_simd::scale(data() + first, value, last - first);
+      } else {
+        std::transform(begin() + first, begin() + last, begin() + first, [&value](const T& a) { return a * value; });
+      }
+    });
     return *this;
   }
 
-  friend matrix operator+(const matrix& left, const matrix& right) {
-    matrix out = left;
-    out += right;
+  // Strassen-Winograd product: while the smallest dimension exceeds threshold, all three are halved (the operands are
+  // padded with zeros to make that possible) and the product of the halves takes 7 multiplications instead of 8;
+  // the blocks below that size go to the classical kernel. All temporaries of the recursion live in one scratch
+  // arena allocated up front, two thirds of the size of one operand.
+  //
+  // The result is not the same as the classical one for floating-point T. Every level adds and subtracts whole blocks
+  // before multiplying them, so the error of an element is bounded by the norms of the operands rather than by the
+  // element's own terms, and the constant of that bound grows about 18x per level (Higham, "Accuracy and Stability
+  // of Numerical Algorithms", ch. 23). Elements much smaller than the largest products can lose all their digits:
+  // keep threshold large, or stay with operator* when that matters. For integer T the result is exact as long as the
+  // block sums, a few times larger than the operands, and their products do not overflow
+  friend matrix multiply_strassen(const matrix& left, const matrix& right, size_t threshold = 256) {
+    matrix out(left.rows(), right.cols());
+    if (out.empty()) {
+      return out;
+    }
+    size_t m = out.rows();
+    size_t k = left.cols();
+    size_t n = out.cols();
+    threshold = std::max<size_t>(threshold, 1);
+    size_t levels = 0;
+    while (std::min({m, k, n}) >> levels > threshold) {
+      ++levels;
+    }
+    size_t step = size_t(1) << levels;
+    size_t pm = (m + step - 1) / step * step;
+    size_t pk = (k + step - 1) / step * step;
+    size_t pn = (n + step - 1) / step * step;
+    bool padded = pm != m || pk != k || pn != n;
+
+    size_t scratch = strassen_scratch(pm, pn, pk, levels);
+    size_t arena_size = scratch + (padded ? pm * pk + pk * pn + pm * pn : 0);
+    storage_guard storage(arena_size);
+    std::uninitialized_value_construct_n(storage.data, arena_size);
+    storage.constructed = arena_size;
+    T* arena = storage.data;
+    if (padded) {
+      T* a = arena + scratch;
+      T* b = a + pm * pk;
+      T* c = b + pk * pn;
+      for (size_t i = 0; i < m; ++i) {
+        std::copy_n(left.row_begin(i), k, a + i * pk);
+      }
+      for (size_t i = 0; i < k; ++i) {
+        std::copy_n(right.row_begin(i), n, b + i * pn);
+      }
+      strassen(a, pk, b, pn, c, pn, pm, pn, pk, levels, arena);
+      for (size_t i = 0; i < m; ++i) {
+        std::copy_n(c + i * pn, n, out.row_begin(i));
+      }
+    } else {
+      strassen(left.data(), k, right.data(), n, out.data(), n, m, n, k, levels, arena);
+    }
     return out;
   }
 
-  friend matrix operator-(const matrix& left, const matrix& right) {
-    matrix out = left;
-    out -= right;
+  // Product split into tile x tile blocks of the result, which threads threads take from a work-stealing pool
+  friend matrix multiply(const matrix& left, const matrix& right, size_t threads, size_t tile) {
+    matrix out(left.rows(), right.cols());
+    multiply_tiles(left, right, out, threads, tile);
     return out;
   }
 
-  friend matrix operator*(const matrix& left, const matrix& right) {
-    matrix out = left;
-    out *= right;
-    return out;
+  // a += b * c accumulates the product straight into a, other expressions are evaluated in one pass
+  template <typename E>
+  matrix& operator+=(const matrix_expr::expression<E>& expr) {
+    const E& e = expr.self();
+    if constexpr (matrix_expr::is_product<E>) {
+      if (&e.left() != this && &e.right() != this) {
+        multiply_add(e.left(), e.right(), *this);
+        return *this;
+      }
+    }
+    return *this = *this + e;
   }
 
-  friend matrix operator*(const matrix& left, const_reference right) {
-    matrix out = left;
-    out *= right;
-    return out;
+  template <typename E>
+  matrix& operator-=(const matrix_expr::expression<E>& expr) {
+    return *this = *this - expr.self();
+  }
+
+  // The operators below build matrix_expr trees, which are evaluated when they are converted to a matrix. Named
+  // operands are referenced by the tree and temporaries are moved into it, so that it never outlives them
+
+  template <typename L, typename R>
+    requires(is_self<L> && is_self<R>)
+  friend auto operator+(L&& left, R&& right) {
+    return matrix_expr::make_binary<std::plus<>>(std::forward<L>(left), std::forward<R>(right));
+  }
+
+  template <typename L, typename R>
+    requires(is_self<L> && is_self<R>)
+  friend auto operator-(L&& left, R&& right) {
+    return matrix_expr::make_binary<std::minus<>>(std::forward<L>(left), std::forward<R>(right));
+  }
+
+  template <typename L, typename R>
+    requires(is_self<L> && is_self<R>)
+  friend auto operator*(L&& left, R&& right) {
+    return matrix_expr::make_product(std::forward<L>(left), std::forward<R>(right));
+  }
+
+  template <typename M>
+    requires is_self<M>
+  friend auto operator*(M&& left, const_reference right) {
+    return matrix_expr::make_scaled(std::forward<M>(left), right);
+  }
+
+  template <typename M>
+    requires is_self<M>
+  friend auto operator*(const_reference left, M&& right) {
+    return matrix_expr::make_scaled(std::forward<M>(right), left);
+  }
+
+private:
+  static constexpr std::align_val_t ALIGNMENT{std::max(matrix_simd::ALIGNMENT, alignof(T))};
+
+  // Uninitialized storage for count elements aligned for the widest vector kernel
+  static T* allocate(size_t count) {
+    return static_cast<T*>(::operator new(count * sizeof(T), ALIGNMENT));
+  }
+
+  static void deallocate(T* data) {
+    ::operator delete(data, ALIGNMENT);
+  }
+
+  // A block from allocate, together with the number of its leading elements that are constructed. Unless release
+  // takes the block, the destructor destroys those elements and frees it, so nothing leaks when a T operation throws
+  struct storage_guard {
+    explicit storage_guard(size_t count) : data(allocate(count)) {}
+
+    storage_guard(const storage_guard&) = delete;
+    storage_guard& operator=(const storage_guard&) = delete;
+
+    ~storage_guard() {
+      std::destroy_n(data, constructed);
+      deallocate(data);
+    }
+
+    T* release() {
+      constructed = 0;
+      return std::exchange(data, nullptr);
+    }
+
+    T* data;
+    size_t constructed = 0;
+  };
+
+  // Takes the block of storage, whose rows * cols elements are all constructed, in place of the empty one
+  void adopt(storage_guard& storage, size_t rows, size_t cols) {
+    data_ = storage.release();
+    rows_ = rows;
+    cols_ = cols;
+  }
+
+  // out += left * right, in parallel once the product reaches matrix_parallel::multiply_threshold multiply-adds
+  static void multiply_add(const matrix& left, const matrix& right, matrix& out) {
+    if (left.rows() * left.cols() * right.cols() < matrix_parallel::multiply_threshold) {
+      multiply_tile(left, right, out, 0, 0, out.rows(), out.cols());
+    } else {
+      multiply_tiles(left, right, out, matrix_parallel::thread_count, matrix_parallel::tile_size);
+    }
+  }
+
+  // out[row, row + m) x [col, col + n) += left * right restricted to these rows and columns
+  static void multiply_tile(const matrix& left, const matrix& right, matrix& out, size_t row, size_t col, size_t m,
+                            size_t n) {
+    multiply_view(left.data() + row * left.cols(), left.cols(), right.data() + col, right.cols(),
+                  out.data() + row * out.cols() + col, out.cols(), m, n, left.cols());
+  }
+
+  // c += a * b, where a is m x k, b is k x n and c is m x n, all stored row by row with strides lda, ldb and ldc
+  static void multiply_view(const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t m, size_t n,
+                            size_t k) {
+    if constexpr (BLOCKED_MULTIPLY) {
+      multiply_blocked(a, lda, b, ldb, c, ldc, m, n, k);
+    } else {
+      for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+          for (size_t p = 0; p < k; ++p) {
+            c[i * ldc + j] += a[i * lda + p] * b[p * ldb + j];
+          }
+        }
+      }
+    }
+  }
+
+  // Scratch taken by strassen on the level for an m x k by k x n product and all levels below it
+  static size_t strassen_scratch(size_t m, size_t n, size_t k, size_t levels) {
+    size_t total = 0;
+    for (; levels > 0; --levels) {
+      m /= 2;
+      n /= 2;
+      k /= 2;
+      total += m * std::max(k, n) + k * n;
+    }
+    return total;
+  }
+
+  // r = p + q or r = p - q for rows x cols blocks, r may be the same block as p or q
+  template <matrix_simd::op Op>
+  static void combine_blocks(T* r, size_t ldr, const T* p, size_t ldp, const T* q, size_t ldq, size_t rows,
+                             size_t cols) {
+    for (size_t i = 0; i < rows; ++i, r += ldr, p += ldp, q += ldq) {
+      for (size_t j = 0; j < cols; ++j) {
+        if constexpr (Op == matrix_simd::op::add) {
+          r[j] = p[j] + q[j];
+        } else {
+          r[j] = p[j] - q[j];
+        }
+      }
+    }
+  }
+
+  // c = a * b, where m, n and k are divisible by 2^levels. Follows the schedule of Boyer, Dumas, Pernet and Zhou,
+  // "Memory efficient scheduling of Strassen-Winograd's matrix multiplication algorithm": the 7 products go straight
+  // into the quadrants of c, and only two temporaries x and y are needed per level
+  static void strassen(const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t m, size_t n, size_t k,
+                       size_t levels, T* scratch) {
+    if (levels == 0) {
+      for (size_t i = 0; i < m; ++i) {
+        std::fill_n(c + i * ldc, n, T());
+      }
+      multiply_view(a, lda, b, ldb, c, ldc, m, n, k);
+      return;
+    }
+    constexpr matrix_simd::op add = matrix_simd::op::add;
+    constexpr matrix_simd::op sub = matrix_simd::op::sub;
+    size_t hm = m / 2;
+    size_t hn = n / 2;
+    size_t hk = k / 2;
+    const T* a11 = a;
+    const T* a12 = a + hk;
+    const T* a21 = a + hm * lda;
+    const T* a22 = a21 + hk;
+    const T* b11 = b;
+    const T* b12 = b + hn;
+    const T* b21 = b + hk * ldb;
+    const T* b22 = b21 + hn;
+    T* c11 = c;
+    T* c12 = c + hn;
+    T* c21 = c + hm * ldc;
+    T* c22 = c21 + hn;
+    // x holds hm x hk sums of a's quadrants and then the hm x hn product p1, y holds hk x hn sums of b's quadrants
+    size_t ldx = std::max(hk, hn);
+    T* x = scratch;
+    T* y = x + hm * ldx;
+    T* next = y + hk * hn;
+    auto mul = [&](const T* p, size_t ldp, const T* q, size_t ldq, T* r, size_t ldr) {
+      strassen(p, ldp, q, ldq, r, ldr, hm, hn, hk, levels - 1, next);
+    };
+
+    combine_blocks<sub>(x, ldx, a11, lda, a21, lda, hm, hk);   // s3 = a11 - a21
+    combine_blocks<sub>(y, hn, b22, ldb, b12, ldb, hk, hn);    // t3 = b22 - b12
+    mul(x, ldx, y, hn, c21, ldc);                              // p7 = s3 t3
+    combine_blocks<add>(x, ldx, a21, lda, a22, lda, hm, hk);   // s1 = a21 + a22
+    combine_blocks<sub>(y, hn, b12, ldb, b11, ldb, hk, hn);    // t1 = b12 - b11
+    mul(x, ldx, y, hn, c22, ldc);                              // p5 = s1 t1
+    combine_blocks<sub>(x, ldx, x, ldx, a11, lda, hm, hk);     // s2 = s1 - a11
+    combine_blocks<sub>(y, hn, b22, ldb, y, hn, hk, hn);       // t2 = b22 - t1
+    mul(x, ldx, y, hn, c12, ldc);                              // p6 = s2 t2
+    combine_blocks<sub>(x, ldx, a12, lda, x, ldx, hm, hk);     // s4 = a12 - s2
+    mul(x, ldx, b22, ldb, c11, ldc);                           // p3 = s4 b22
+    mul(a11, lda, b11, ldb, x, ldx);                           // p1 = a11 b11
+    combine_blocks<add>(c12, ldc, x, ldx, c12, ldc, hm, hn);   // u2 = p1 + p6
+    combine_blocks<add>(c21, ldc, c12, ldc, c21, ldc, hm, hn); // u3 = u2 + p7
+    combine_blocks<add>(c12, ldc, c12, ldc, c22, ldc, hm, hn); // u4 = u2 + p5
+    combine_blocks<add>(c22, ldc, c21, ldc, c22, ldc, hm, hn); // u7 = u3 + p5, the final c22
+    combine_blocks<add>(c12, ldc, c12, ldc, c11, ldc, hm, hn); // u5 = u4 + p3, the final c12
+    combine_blocks<sub>(y, hn, y, hn, b21, ldb, hk, hn);       // t4 = t2 - b21
+    mul(a22, lda, y, hn, c11, ldc);                            // p4 = a22 t4
+    combine_blocks<sub>(c21, ldc, c21, ldc, c11, ldc, hm, hn); // u6 = u3 - p4, the final c21
+    mul(a12, lda, b21, ldb, c11, ldc);                         // p2 = a12 b21
+    combine_blocks<add>(c11, ldc, x, ldx, c11, ldc, hm, hn);   // u1 = p1 + p2, the final c11
+  }
+
+  static void multiply_tiles(const matrix& left, const matrix& right, matrix& out, size_t threads, size_t tile) {
+    tile = std::max<size_t>(tile, 1);
+    size_t tile_rows = (out.rows() + tile - 1) / tile;
+    size_t tile_cols = (out.cols() + tile - 1) / tile;
+    matrix_parallel::for_each(tile_rows * tile_cols, threads, [&](size_t index) {
+      size_t row = index / tile_cols * tile;
+      size_t col = index % tile_cols * tile;
+      multiply_tile(left, right, out, row, col, std::min(tile, out.rows() - row), std::min(tile, out.cols() - col));
+    });
+  }
+
+  // Blocked multiplication in the style of GotoBLAS: a KC x NC panel of B and an MC x KC block of A are packed into
+  // contiguous buffers sized for L2 and L1 respectively, the packed A block is split into MR-row slivers and the packed
+  // B panel into NR-column slivers, and every MR x NR tile of C is computed by a micro-kernel that keeps it in registers
+  static constexpr bool BLOCKED_MULTIPLY = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+  static constexpr size_t GEMM_MR = 4;
+  static constexpr size_t GEMM_NR = sizeof(T) >= 32 ? 1 : 32 / sizeof(T);
+  static constexpr size_t GEMM_KC = 256;
+  static constexpr size_t GEMM_MC = 32 * GEMM_MR;
+  static constexpr size_t GEMM_NC = 2048 / GEMM_NR * GEMM_NR;
+
+  // Copies the rows [0, m) of a k-column block with stride ld into MR-row slivers stored column by column, the last
+  // sliver is padded with zeros
+  static void pack_a(const T* a, size_t ld, size_t m, size_t k, T* out) {
+    for (size_t i = 0; i < m; i += GEMM_MR) {
+      size_t mr = std::min(GEMM_MR, m - i);
+      for (size_t p = 0; p < k; ++p) {
+        for (size_t r = 0; r < GEMM_MR; ++r) {
+          *out++ = r < mr ? a[(i + r) * ld + p] : T();
+        }
+      }
+    }
+  }
+
+  // Copies the columns [0, n) of a k-row block with stride ld into NR-column slivers stored row by row, the last
+  // sliver is padded with zeros
+  static void pack_b(const T* b, size_t ld, size_t n, size_t k, T* out) {
+    for (size_t j = 0; j < n; j += GEMM_NR) {
+      size_t nr = std::min(GEMM_NR, n - j);
+      for (size_t p = 0; p < k; ++p) {
+        const T* row = b + p * ld + j;
+        for (size_t c = 0; c < GEMM_NR; ++c) {
+          *out++ = c < nr ? row[c] : T();
+        }
+      }
+    }
   }
 
-  friend matrix operator*(const_reference left, const matrix& right) {
-    return right * left;
+  // c[0, mr) x [0, nr) += a * b for an MR-row sliver a and an NR-column sliver b of length k
+  static void micro_kernel(const T* a, const T* b, size_t k, T* c, size_t ldc, size_t mr, size_t nr) {
+    T acc[GEMM_MR][GEMM_NR] = {};
+    for (size_t p = 0; p < k; ++p, a += GEMM_MR, b += GEMM_NR) {
+      for (size_t r = 0; r < GEMM_MR; ++r) {
+        for (size_t col = 0; col < GEMM_NR; ++col) {
+          acc[r][col] += a[r] * b[col];
+        }
+      }
+    }
+    for (size_t r = 0; r < mr; ++r) {
+      for (size_t col = 0; col < nr; ++col) {
+        c[r * ldc + col] += acc[r][col];
+      }
+    }
+  }
+
+  // Same contract as multiply_view
+  static void multiply_blocked(const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t m, size_t n,
+                               size_t k) {
+    if (m == 0 || n == 0 || k == 0) {
+      return;
+    }
+    size_t kc_max = std::min(GEMM_KC, k);
+    size_t mc_max = (std::min(GEMM_MC, m) + GEMM_MR - 1) / GEMM_MR * GEMM_MR;
+    size_t nc_max = (std::min(GEMM_NC, n) + GEMM_NR - 1) / GEMM_NR * GEMM_NR;
+    storage_guard packed(mc_max * kc_max + kc_max * nc_max);
+    T* packed_a = packed.data;
+    T* packed_b = packed_a + mc_max * kc_max;
+
+    for (size_t jc = 0; jc < n; jc += GEMM_NC) {
+      size_t nc = std::min(GEMM_NC, n - jc);
+      for (size_t pc = 0; pc < k; pc += GEMM_KC) {
+        size_t kc = std::min(GEMM_KC, k - pc);
+        pack_b(b + pc * ldb + jc, ldb, nc, kc, packed_b);
+        for (size_t ic = 0; ic < m; ic += GEMM_MC) {
+          size_t mc = std::min(GEMM_MC, m - ic);
+          pack_a(a + ic * lda + pc, lda, mc, kc, packed_a);
+          for (size_t jr = 0; jr < nc; jr += GEMM_NR) {
+            for (size_t ir = 0; ir < mc; ir += GEMM_MR) {
+              micro_kernel(packed_a + ir * kc, packed_b + jr * kc, kc, c + (ic + ir) * ldc + jc + jr, ldc,
+                           std::min(GEMM_MR, mc - ir), std::min(GEMM_NR, nc - jr));
+            }
+          }
+        }
+      }
+    }
   }
 };
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace matrix_parallel {
+
+// Threads used by operator* and the element-wise operators, the calling one included; 1 keeps them serial
+inline size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+// Side of the square output tiles that operator* hands out to the threads
+inline size_t tile_size = 256;
+// operator* runs in parallel once rows * inner * cols of the product reaches this many multiply-adds
+inline size_t multiply_threshold = size_t(1) << 21;
+// The element-wise operators run in parallel once the matrices reach this many elements
+inline size_t elementwise_threshold = size_t(1) << 20;
+
+// Work-stealing pool for index ranges: run(count, task) gives every thread an equal contiguous share of [0, count),
+// a thread takes the indices of its own share from the front, and once it is exhausted steals the back half of
+// another thread's share. Nothing is queued, so there are no containers and no locks on the hot path
+class thread_pool {
+public:
+  // threads counts the calling thread as well
+  explicit thread_pool(size_t threads)
+      : size_(std::max<size_t>(threads, 1)),
+        shares_(new share[size_]),
+        workers_(new std::thread[size_ - 1]) {
+    for (size_t slot = 1; slot < size_; ++slot) {
+      workers_[slot - 1] = std::thread([this, slot] { work(slot); });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (size_t i = 0; i + 1 < size_; ++i) {
+      workers_[i].join();
+    }
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Calls task(i) for every i in [0, count) and waits for all of them, the first exception is rethrown.
+  // Calls from different threads are serialized
+  template <typename F>
+  void run(size_t count, const F& task) {
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    for (size_t slot = 0; slot < size_; ++slot) {
+      shares_[slot].range.store(pack(count * slot / size_, count * (slot + 1) / size_), std::memory_order_relaxed);
+    }
+    context_ = &task;
+    invoke_ = [](const void* context, size_t i) { (*static_cast<const F*>(context))(i); };
+    error_ = nullptr;
+    busy_.store(size_ - 1, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    drain(0);
+    while (busy_.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+private:
+  // [begin, end) of the indices left to a thread, packed into one word so that both ends change atomically
+  struct alignas(64) share {
+    std::atomic<uint64_t> range{0};
+  };
+
+  static uint64_t pack(uint64_t begin, uint64_t end) {
+    return begin | end << 32;
+  }
+
+  static uint64_t begin_of(uint64_t range) {
+    return range & 0xffffffff;
+  }
+
+  static uint64_t end_of(uint64_t range) {
+    return range >> 32;
+  }
+
+  // Takes the front index of the own share
+  bool pop(size_t slot, size_t& index) {
+    std::atomic<uint64_t>& range = shares_[slot].range;
+    uint64_t current = range.load(std::memory_order_relaxed);
+    while (begin_of(current) < end_of(current)) {
+      if (range.compare_exchange_weak(current, pack(begin_of(current) + 1, end_of(current)),
+                                      std::memory_order_relaxed)) {
+        index = begin_of(current);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Moves the back half of some other share into the own one, which is empty at that point
+  bool steal(size_t slot) {
+    for (size_t i = 1; i < size_; ++i) {
+      std::atomic<uint64_t>& victim = shares_[(slot + i) % size_].range;
+      uint64_t current = victim.load(std::memory_order_relaxed);
+      while (begin_of(current) < end_of(current)) {
+        uint64_t middle = begin_of(current) + (end_of(current) - begin_of(current)) / 2;
+        if (victim.compare_exchange_weak(current, pack(begin_of(current), middle), std::memory_order_relaxed)) {
+          shares_[slot].range.store(pack(middle, end_of(current)), std::memory_order_relaxed);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void drain(size_t slot) {
+    size_t index;
+    do {
+      while (pop(slot, index)) {
+        try {
+          invoke_(context_, index);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mutex_);
+          if (!error_) {
+            error_ = std::current_exception();
+          }
+        }
+      }
+    } while (steal(slot));
+  }
+
+  void work(size_t slot) {
+    size_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+      }
+      drain(slot);
+      busy_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  size_t size_;
+  std::unique_ptr<share[]> shares_;
+  std::unique_ptr<std::thread[]> workers_;
+
+  std::mutex run_mutex_;
+  const void* context_ = nullptr;
+  void (*invoke_)(const void*, size_t) = nullptr;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+  // workers that have not finished the current run yet
+  std::atomic<size_t> busy_{0};
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  size_t generation_ = 0;
+  bool stop_ = false;
+};
+
+// One pool per number of threads, created on first use and kept until exit, so that a pool is never destroyed while
+// another thread may still be inside run()
+inline thread_pool& shared_pool(size_t threads) {
+  struct entry {
+    entry(size_t threads, std::unique_ptr<entry> next) : pool(threads), next(std::move(next)) {}
+
+    thread_pool pool;
+    std::unique_ptr<entry> next;
+  };
+  static std::mutex mutex;
+  static std::unique_ptr<entry> pools;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (entry* e = pools.get(); e != nullptr; e = e->next.get()) {
+    if (e->pool.size() == threads) {
+      return e->pool;
+    }
+  }
+  pools = std::make_unique<entry>(threads, std::move(pools));
+  return pools->pool;
+}
+
+// task(i) for every i in [0, count) on threads threads, or serially if there is only one thread or one index
+template <typename F>
+void for_each(size_t count, size_t threads, const F& task) {
+  if (threads <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      task(i);
+    }
+    return;
+  }
+  shared_pool(threads).run(count, task);
+}
+
+// task(begin, end) over consecutive chunks of [0, n), spread over thread_count threads once n reaches
+// elementwise_threshold. Chunks are multiples of 64 elements, so two threads never write to one cache line of
+// 64-byte aligned storage
+template <typename F>
+void for_each_chunk(size_t n, const F& task) {
+  if (n == 0) {
+    return;
+  }
+  if (thread_count <= 1 || n < elementwise_threshold) {
+    task(size_t(0), n);
+    return;
+  }
+  size_t chunk = std::max<size_t>(64, (n / (4 * thread_count) + 63) / 64 * 64);
+  for_each((n + chunk - 1) / chunk, thread_count, [&](size_t i) { task(i * chunk, std::min(n, (i + 1) * chunk)); });
+}
+
+} // namespace matrix_parallel
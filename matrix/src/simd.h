@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Element-wise kernels over contiguous arrays for float, double and 32/64-bit integers. On x86 with GCC or Clang each
+// kernel is compiled for SSE2, AVX2 and AVX-512 and the widest one the CPU supports is picked at runtime, elsewhere
+// they are plain loops
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATRIX_SIMD_DISPATCH 1
+#include <immintrin.h>
+#else
+#define MATRIX_SIMD_DISPATCH 0
+#endif
+
+namespace matrix_simd {
+
+template <typename T>
+inline constexpr bool supported =
+    std::is_same_v<T, float> || std::is_same_v<T, double> ||
+    (std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+// Alignment of matrix storage: a whole AVX-512 register, so no vector load ever crosses a cache line
+inline constexpr size_t ALIGNMENT = 64;
+
+enum class op { add, sub };
+
+#if MATRIX_SIMD_DISPATCH
+
+enum class level { sse2, avx2, avx512 };
+
+inline level detect_level() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+    return level::avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return level::avx2;
+  }
+  return level::sse2;
+}
+
+inline level current_level() {
+  static const level value = detect_level();
+  return value;
+}
+
+// The kernels are only ever inlined into the target-specific wrappers below, so Bytes-wide vectors are compiled with
+// the instruction set of the wrapper. Vectors are accessed through an element-aligned, aliasing view of the arrays:
+// matrix storage is aligned anyway, and nothing vector-typed crosses a function boundary
+template <size_t Bytes, typename T>
+using vector_view [[gnu::vector_size(Bytes), gnu::aligned(sizeof(T)), gnu::may_alias]] = T;
+
+template <size_t Bytes, op Op, typename T>
+[[gnu::always_inline]] inline void combine_kernel(T* dst, const T* src, size_t n) {
+  using vec = vector_view<Bytes, T>;
+  constexpr size_t LANES = Bytes / sizeof(T);
+  size_t i = 0;
+  for (; i + 2 * LANES <= n; i += 2 * LANES) {
+    vec* d = reinterpret_cast<vec*>(dst + i);
+    const vec* s = reinterpret_cast<const vec*>(src + i);
+    if constexpr (Op == op::add) {
+      d[0] += s[0];
+      d[1] += s[1];
+    } else {
+      d[0] -= s[0];
+      d[1] -= s[1];
+    }
+  }
+  for (; i < n; ++i) {
+    if constexpr (Op == op::add) {
+      dst[i] += src[i];
+    } else {
+      dst[i] -= src[i];
+    }
+  }
+}
+
+template <size_t Bytes, typename T>
+[[gnu::always_inline]] inline void scale_kernel(T* dst, T factor, size_t n) {
+  using vec = vector_view<Bytes, T>;
+  constexpr size_t LANES = Bytes / sizeof(T);
+  size_t i = 0;
+  for (; i + 2 * LANES <= n; i += 2 * LANES) {
+    vec* d = reinterpret_cast<vec*>(dst + i);
+    d[0] *= factor;
+    d[1] *= factor;
+  }
+  for (; i < n; ++i) {
+    dst[i] *= factor;
+  }
+}
+
+// Compares a block of vectors at a time and tests the accumulated lane masks once per block, which keeps the early
+// exit without a horizontal reduction on every load
+template <size_t Bytes, typename T>
+[[gnu::always_inline]] inline bool equal_kernel(const T* a, const T* b, size_t n) {
+  using vec = vector_view<Bytes, T>;
+  constexpr size_t BLOCK = 8;
+  constexpr size_t LANES = Bytes / sizeof(T);
+  size_t i = 0;
+  for (; i + BLOCK * LANES <= n; i += BLOCK * LANES) {
+    const vec* x = reinterpret_cast<const vec*>(a + i);
+    const vec* y = reinterpret_cast<const vec*>(b + i);
+    auto diff = x[0] != y[0];
+    for (size_t j = 1; j < BLOCK; ++j) {
+      diff |= x[j] != y[j];
+    }
+    uint64_t words[Bytes / sizeof(uint64_t)];
+    __builtin_memcpy(words, &diff, Bytes);
+    uint64_t any = 0;
+    for (uint64_t word : words) {
+      any |= word;
+    }
+    if (any != 0) {
+      return false;
+    }
+  }
+  for (; i < n; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <op Op, typename T>
+[[gnu::target("sse2")]] void combine_sse2(T* dst, const T* src, size_t n) {
+  combine_kernel<16, Op>(dst, src, n);
+}
+
+template <op Op, typename T>
+[[gnu::target("avx2")]] void combine_avx2(T* dst, const T* src, size_t n) {
+  combine_kernel<32, Op>(dst, src, n);
+}
+
+template <op Op, typename T>
+[[gnu::target("avx512f,avx512dq")]] void combine_avx512(T* dst, const T* src, size_t n) {
+  combine_kernel<64, Op>(dst, src, n);
+}
+
+template <typename T>
+[[gnu::target("sse2")]] void scale_sse2(T* dst, T factor, size_t n) {
+  scale_kernel<16>(dst, factor, n);
+}
+
+template <typename T>
+[[gnu::target("avx2")]] void scale_avx2(T* dst, T factor, size_t n) {
+  scale_kernel<32>(dst, factor, n);
+}
+
+template <typename T>
+[[gnu::target("avx512f,avx512dq")]] void scale_avx512(T* dst, T factor, size_t n) {
+  scale_kernel<64>(dst, factor, n);
+}
+
+template <typename T>
+[[gnu::target("sse2")]] bool equal_sse2(const T* a, const T* b, size_t n) {
+  return equal_kernel<16>(a, b, n);
+}
+
+template <typename T>
+[[gnu::target("avx2")]] bool equal_avx2(const T* a, const T* b, size_t n) {
+  return equal_kernel<32>(a, b, n);
+}
+
+// GCC scalarizes generic vector comparisons that produce AVX-512 mask registers, so this one is written with intrinsics
+template <typename T>
+[[gnu::target("avx512f,avx512dq")]] bool equal_avx512(const T* a, const T* b, size_t n) {
+  constexpr size_t LANES = 64 / sizeof(T);
+  size_t i = 0;
+  for (; i + LANES <= n; i += LANES) {
+    unsigned not_equal;
+    if constexpr (std::is_same_v<T, float>) {
+      not_equal = _mm512_cmp_ps_mask(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), _CMP_NEQ_UQ);
+    } else if constexpr (std::is_same_v<T, double>) {
+      not_equal = _mm512_cmp_pd_mask(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), _CMP_NEQ_UQ);
+    } else if constexpr (sizeof(T) == 4) {
+      not_equal = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+    } else {
+      not_equal = _mm512_cmpneq_epi64_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+    }
+    if (not_equal != 0) {
+      return false;
+    }
+  }
+  for (; i < n; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// dst[i] = dst[i] + src[i] or dst[i] - src[i] for i in [0, n)
+template <op Op, typename T>
+void combine(T* dst, const T* src, size_t n) {
+  switch (current_level()) {
+  case level::avx512:
+    return combine_avx512<Op>(dst, src, n);
+  case level::avx2:
+    return combine_avx2<Op>(dst, src, n);
+  default:
+    return combine_sse2<Op>(dst, src, n);
+  }
+}
+
+// dst[i] *= factor for i in [0, n)
+template <typename T>
+void scale(T* dst, T factor, size_t n) {
+  switch (current_level()) {
+  case level::avx512:
+    return scale_avx512(dst, factor, n);
+  case level::avx2:
+    return scale_avx2(dst, factor, n);
+  default:
+    return scale_sse2(dst, factor, n);
+  }
+}
+
+// Whether a[i] == b[i] for every i in [0, n), with the same NaN and signed zero semantics as the scalar comparison
+template <typename T>
+bool equal(const T* a, const T* b, size_t n) {
+  switch (current_level()) {
+  case level::avx512:
+    return equal_avx512(a, b, n);
+  case level::avx2:
+    return equal_avx2(a, b, n);
+  default:
+    return equal_sse2(a, b, n);
+  }
+}
+
+#else
+
+template <op Op, typename T>
+void combine(T* dst, const T* src, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if constexpr (Op == op::add) {
+      dst[i] += src[i];
+    } else {
+      dst[i] -= src[i];
+    }
+  }
+}
+
+template <typename T>
+void scale(T* dst, T factor, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] *= factor;
+  }
+}
+
+template <typename T>
+bool equal(const T* a, const T* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif
+
+} // namespace matrix_simd